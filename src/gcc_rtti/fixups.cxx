@@ -0,0 +1,120 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#include <stdinc.hxx>
+
+#include "fixups.hxx"
+
+void fixups_t::build(const gcc_rtti_t::segments_data_t &segments_data)
+{
+	clear();
+
+	// only fixups of data segments are interesting, so code fixups are not even visited
+	for (const gcc_rtti_t::segment_data_t &segment_data : segments_data)
+	{
+		for (ea_t source = get_next_fixup_ea(segment_data.m_start_ea - 1);
+			 source != BADADDR && source < segment_data.m_end_ea;
+			 source = get_next_fixup_ea(source))
+		{
+			const ea_t target = utils::get_fixup_target(source);
+			if (target == BADADDR)
+			{
+				continue;
+			}
+
+			m_sources.push_back(source);
+			m_targets.push_back(target);
+		}
+	}
+
+	// segments do not have to be sorted, but lookup by source requires it
+	if (!std::is_sorted(m_sources.begin(), m_sources.end()))
+	{
+		array_dyn_t<uint32> order;
+		order.resize(m_sources.size());
+		for (uint32 i = 0; i < order.size(); ++i)
+		{
+			order[i] = i;
+		}
+
+		std::sort(order.begin(), order.end(), [this](const uint32 lhs, const uint32 rhs)
+		{
+			return m_sources[lhs] < m_sources[rhs];
+		});
+
+		array_dyn_t<ea_t> sources, targets;
+		sources.reserve(order.size());
+		targets.reserve(order.size());
+		for (const uint32 i : order)
+		{
+			sources.push_back(m_sources[i]);
+			targets.push_back(m_targets[i]);
+		}
+		m_sources.swap(sources);
+		m_targets.swap(targets);
+	}
+
+	m_by_target.resize(m_sources.size());
+	for (uint32 i = 0; i < m_by_target.size(); ++i)
+	{
+		m_by_target[i] = i;
+	}
+
+	std::sort(m_by_target.begin(), m_by_target.end(), [this](const uint32 lhs, const uint32 rhs)
+	{
+		return m_targets[lhs] < m_targets[rhs] || (m_targets[lhs] == m_targets[rhs] && lhs < rhs);
+	});
+}
+
+void fixups_t::clear()
+{
+	m_sources.clear();
+	m_targets.clear();
+	m_by_target.clear();
+}
+
+bool fixups_t::empty() const
+{
+	return m_sources.empty();
+}
+
+size_t fixups_t::size() const
+{
+	return m_sources.size();
+}
+
+ea_t fixups_t::get_target(const ea_t source) const
+{
+	const auto found = std::lower_bound(m_sources.begin(), m_sources.end(), source);
+	if (found == m_sources.end() || *found != source)
+	{
+		return BADADDR;
+	}
+	return m_targets[found - m_sources.begin()];
+}
+
+void fixups_t::find_sources(const ea_t target, array_dyn_t<ea_t> &result) const
+{
+	auto found = std::lower_bound(m_by_target.begin(), m_by_target.end(), target,
+		[this](const uint32 index, const ea_t value)
+		{
+			return m_targets[index] < value;
+		}
+	);
+
+	for (; found != m_by_target.end() && m_targets[*found] == target; ++found)
+	{
+		result.push_back(m_sources[*found]);
+	}
+}
+
+/* eof */
@@ -0,0 +1,43 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#pragma once
+
+#include "gcc_rtti.hxx"
+
+/**
+ * Index of database fixups (relocations) placed in data segments.
+ * In position independent binaries pointers in .data.rel.ro may be zero in file image, or point to
+ * extern symbols, so their real targets are known only from relocations.
+ */
+class fixups_t
+{
+public:
+	void build(const gcc_rtti_t::segments_data_t &segments_data);
+	void clear();
+
+	bool empty() const;
+	size_t size() const;
+
+	/* target of fixup placed at source, BADADDR if there is no fixup */
+	ea_t get_target(const ea_t source) const;
+
+	/* all fixups pointing to target, in ascending order */
+	void find_sources(const ea_t target, array_dyn_t<ea_t> &result) const;
+
+private:
+	array_dyn_t<ea_t>	m_sources;	// ascending, as fixups are enumerated
+	array_dyn_t<ea_t>	m_targets;	// target of m_sources[i]
+	array_dyn_t<uint32>	m_by_target;// indices sorted by target
+};
+
+/* eof */
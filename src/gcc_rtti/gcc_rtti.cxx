@@ -15,16 +15,44 @@
 #include "gcc_rtti.hxx"
 
 #include "graph.hxx"
+#include "hierarchy.hxx"
+#include "known_types.hxx"
+#include "tracker.hxx"
+#include "fixups.hxx"
+#include "symbols.hxx"
+#include "vtables.hxx"
+#include "snapshot.hxx"
+#include "overrides.hxx"
+#include "structors.hxx"
+#include "layouts.hxx"
+
+const gcc_rtti_t::ti_kind_t gcc_rtti_t::ti_kinds[gcc_rtti_t::TI_COUNT] = {
+	// name											description						layout	formatter								class
+	{ "St9type_info",								"standard type info classes",	"",		&gcc_rtti_t::format_type_info,			true  },
+	{ "N10__cxxabiv117__class_type_infoE",			"simple classes",				"",		&gcc_rtti_t::format_type_info,			true  },
+	{ "N10__cxxabiv120__si_class_type_infoE",		"single-inheritance classes",	"",		&gcc_rtti_t::format_si_type_info,		true  },
+	{ "N10__cxxabiv121__vmi_class_type_infoE",		"multiple-inheritance classes",	"",		&gcc_rtti_t::format_vmi_type_info,		true  },
+	{ "N10__cxxabiv119__pointer_type_infoE",		"pointer types",				"iap",	&gcc_rtti_t::format_plain_type_info,	false }, // flags, pointee
+	{ "N10__cxxabiv129__pointer_to_member_type_infoE", "pointer to member types",	"iapp",	&gcc_rtti_t::format_plain_type_info,	false }, // flags, pointee, context
+	{ "N10__cxxabiv120__function_type_infoE",		"function types",				"",		&gcc_rtti_t::format_plain_type_info,	false },
+	{ "N10__cxxabiv116__enum_type_infoE",			"enum types",					"",		&gcc_rtti_t::format_plain_type_info,	false },
+	{ "N10__cxxabiv123__fundamental_type_infoE",	"fundamental types",			"",		&gcc_rtti_t::format_plain_type_info,	false },
+	{ "N10__cxxabiv117__array_type_infoE",			"array types",					"",		&gcc_rtti_t::format_plain_type_info,	false },
+};
 
-const string gcc_rtti_t::ti_names[gcc_rtti_t::TI_COUNT] = {
-	"St9type_info",
-	"N10__cxxabiv117__class_type_infoE",
-	"N10__cxxabiv120__si_class_type_infoE",
-	"N10__cxxabiv121__vmi_class_type_infoE",
+const string gcc_rtti_t::status_names[gcc_rtti_t::STATUS_COUNT] = {
+	"ok",
+	"bad_options",
+	"no_strings",
+	"no_classes",
+	"output_failed",
 };
 
 gcc_rtti_t::gcc_rtti_t()
 	: m_current_class_id(0)
+	, m_console(false)
+	, m_fixups_only(false)
+	, m_outputs_stale(false)
 {
 }
 
@@ -34,17 +62,53 @@ gcc_rtti_t::~gcc_rtti_t()
 
 bool gcc_rtti_t::init()
 {
+	hierarchy_t::register_idc_functions();
 	return true;
 }
 
 void gcc_rtti_t::destroy()
 {
+	hierarchy_t::unregister_idc_functions();
 	m_segments_data.clear();
 	m_strings.clear();
 	m_graph.reset();
+	m_hierarchy.reset();
+	m_overrides.reset();
+	m_known_types.reset();
+	m_tracker.reset();
+	m_fixups.reset();
+	m_symbols.reset();
+	m_snapshot.reset();
+}
+
+void gcc_rtti_t::run(const size_t arg)
+{
+	m_options = options_t();
+	m_options.m_batch = (arg & RUN_BATCH) != 0;
+	m_outputs.clear();
+
+	status_t status = STATUS_BAD_OPTIONS;
+	if (m_options.parse(get_plugin_options("gcc_rtti")))
+	{
+		if (m_options.m_batch)
+		{
+			auto_wait(); // headless run may start before analysis is finished
+		}
+		status = analyze();
+	}
+
+	if (m_options.m_batch)
+	{
+		write_summary(status);
+
+		if (m_options.m_exit)
+		{
+			qexit(static_cast<int>(status));
+		}
+	}
 }
 
-void gcc_rtti_t::run()
+auto gcc_rtti_t::analyze() -> status_t
 {
 	// turn on GCC3 demangling
 	inf.demnames |= DEMNAM_GCC3;
@@ -53,43 +117,262 @@ void gcc_rtti_t::run()
 	m_strings = utils::get_strings();
 	if (m_strings.empty())
 	{
-		warning("Strings list is empty, generate strings list firstly.");
-		return;
+		if (m_options.m_batch)
+		{
+			msg("Strings list is empty, generate strings list firstly.\n");
+		}
+		else
+		{
+			warning("Strings list is empty, generate strings list firstly.");
+		}
+		return STATUS_NO_STRINGS;
+	}
+
+	if (m_tracker)
+	{
+		m_tracker->stop();
 	}
 
 	m_classes.clear();
+	m_hierarchy.reset();
+	m_overrides.reset();
+	m_known_pending.clear();
+	m_pending_vtables.clear();
+	m_classes_by_name.clear();
+	m_outputs_stale = false;
 	m_current_class_id = 0;
 
+	for (array_dyn_t<ea_t> &vtables : m_ti_vtables)
+	{
+		vtables.clear();
+	}
+
+	m_known_types.reset();
+	if (!m_options.m_known_types.empty())
+	{
+		m_known_types = std::make_unique<known_types_t>();
+		if (!m_known_types->load(m_options.m_known_types.c_str()))
+		{
+			return STATUS_BAD_OPTIONS;
+		}
+	}
+
+	m_snapshot.reset();
+	if (!m_options.m_diff.empty())
+	{
+		m_snapshot = std::make_unique<snapshot_t>();
+		if (!m_snapshot->load(m_options.m_diff.c_str()))
+		{
+			return STATUS_BAD_OPTIONS;
+		}
+	}
+
 	initialize_segments_data();
 
+	m_fixups.reset();
+	if (m_options.m_discovery != options_t::DISCOVERY_SCAN)
+	{
+		m_fixups = std::make_unique<fixups_t>();
+		m_fixups->build(m_segments_data);
+
+		if (m_fixups->empty())
+		{
+			m_fixups.reset();
+		}
+	}
+
+	if (m_options.m_discovery == options_t::DISCOVERY_FIXUPS && !m_fixups)
+	{
+		msg("There are no fixups in data segments, falling back to scanning.\n");
+	}
+
+	// non-PIE executables have a few fixups too (i.e. .got), but most of pointers have none,
+	// so unless asked for, relocations only add references which are not visible in bytes
+	m_fixups_only = m_fixups && m_options.m_discovery == options_t::DISCOVERY_FIXUPS;
+
+	m_symbols.reset();
+	if (m_options.m_symbols != options_t::SYMBOLS_OFF)
+	{
+		m_symbols = std::make_unique<symbols_t>();
+		m_symbols->build();
+
+		if (m_symbols->empty())
+		{
+			m_symbols.reset();
+		}
+	}
+
 	// there is no way to get stdout/in from IDA application,
 	// so we must create system console and use cstdlib stdout/in instead
 	// that means also using standard printf (not qprintf)
-	utils::operating_system_t::create_console();
+	// in batch mode stdout of IDA process is used directly
+	if (!m_options.m_batch)
+	{
+		utils::operating_system_t::create_console();
+	}
+	m_console = true;
+
+	if (m_fixups)
+	{
+		log("Using %u fixups of data segments to find references%s\n", static_cast<uint>(m_fixups->size()), m_fixups_only ? "" : ", data is scanned too");
+	}
+
+	if (m_symbols)
+	{
+		log("Using symbols: %u type infos, %u vtables, %u type names\n",
+			static_cast<uint>(m_symbols->get_type_infos().size()),
+			static_cast<uint>(m_symbols->get_vtables_count()),
+			static_cast<uint>(m_symbols->get_type_names_count()));
+	}
 
-	printf("Looking for standard type info classes\n");
+	log("Looking for standard type info classes\n");
 	find_type_info(TI_TINFO);
 	find_type_info(TI_CTINFO);
 	find_type_info(TI_SICTINFO);
 	find_type_info(TI_VMICTINFO);
 
-	printf("Looking for simple classes\n");
-	handle_classes(TI_CTINFO, &gcc_rtti_t::format_type_info);
+	handle_type_infos();
+
+	resolve_known_bases();
+	resolve_pending_vtables();
+
+	if (m_options.m_vtables == options_t::VTABLES_ON || (m_options.m_vtables == options_t::VTABLES_AUTO && m_classes.empty()))
+	{
+		log("Looking for vtables without type info\n");
+		handle_vtables();
+	}
 
-	printf("Looking for single-inheritance classes\n");
-	handle_classes(TI_SICTINFO, &gcc_rtti_t::format_si_type_info);
+	log("Building class hierarchy\n");
+	m_hierarchy = std::make_unique<hierarchy_t>();
+	m_hierarchy->build(m_classes);
 
-	printf("Looking for multiple-inheritance classes\n");
-	handle_classes(TI_VMICTINFO, &gcc_rtti_t::format_vmi_type_info);
+	if (m_options.m_batch)
+	{
+		msg("Success, found %u classes.\n", static_cast<uint>(m_classes.size()));
+	}
+	else
+	{
+		info("Success, found %u classes.", static_cast<uint>(m_classes.size()));
 
-	info("Success, found %u classes.", static_cast<uint>(m_classes.size()));
+		// destroy console which was created
+		utils::operating_system_t::destroy_console();
+		m_console = false;
+	}
 
-	// destroy console which was created
-	utils::operating_system_t::destroy_console();
+	if (m_classes.empty())
+	{
+		return STATUS_NO_CLASSES;
+	}
 
 	// create graph
 	m_graph = std::make_unique<graph_t>();
-	m_graph->run();
+	if (!m_graph->run(m_options, m_outputs))
+	{
+		return STATUS_OUTPUT_FAILED;
+	}
+
+	if (!m_options.m_known_types_save.empty() && !m_options.m_dry_run)
+	{
+		if (!known_types_t::save(m_classes, m_options.m_known_types_save.c_str()))
+		{
+			return STATUS_OUTPUT_FAILED;
+		}
+		m_outputs.push_back(m_options.m_known_types_save);
+	}
+
+	if (m_snapshot && !diff_snapshot())
+	{
+		return STATUS_OUTPUT_FAILED;
+	}
+
+	// after names and comments have been ported, so these are not overwritten by generated ones
+	if (m_options.m_overrides != options_t::OVERRIDES_OFF)
+	{
+		apply_overrides();
+	}
+
+	if (m_options.m_structors)
+	{
+		handle_structors();
+	}
+
+	if (m_options.m_layouts)
+	{
+		handle_layouts();
+	}
+
+	if (!m_options.m_snapshot_save.empty() && !m_options.m_dry_run)
+	{
+		snapshot_t snapshot;
+		snapshot.collect(*this);
+		if (!snapshot.save(m_options.m_snapshot_save.c_str()))
+		{
+			return STATUS_OUTPUT_FAILED;
+		}
+		m_outputs.push_back(m_options.m_snapshot_save);
+	}
+
+	// keep classes up to date with later changes of database
+	if (!m_options.m_batch && m_options.m_track)
+	{
+		if (!m_tracker)
+		{
+			m_tracker = std::make_unique<tracker_t>();
+		}
+		m_tracker->start();
+	}
+
+	return STATUS_OK;
+}
+
+void gcc_rtti_t::write_summary(const status_t status) const
+{
+	size_t bases_count = 0;
+	for (const auto &class_pair : m_classes)
+	{
+		if (class_pair.second)
+		{
+			bases_count += class_pair.second->m_bases.size();
+		}
+	}
+
+	const char *const database = get_path(PATH_TYPE_IDB);
+
+	// single line of JSON, so it can be grepped out of IDA log as well
+	sstring_t summary;
+	summary.sprnt
+	(
+		"{\"status\":%d,\"status_name\":\"%s\",\"database\":\"%s\",\"classes\":%u,\"bases\":%u,\"dry_run\":%s,\"outputs\":[",
+		static_cast<int>(status),
+		status_names[status],
+		utils::escape_string(database ? database : "").c_str(),
+		static_cast<uint>(m_classes.size()),
+		static_cast<uint>(bases_count),
+		m_options.m_dry_run ? "true" : "false"
+	);
+
+	for (size_t i = 0; i < m_outputs.size(); ++i)
+	{
+		summary.cat_sprnt("%s\"%s\"", i ? "," : "", utils::escape_string(m_outputs[i].c_str()).c_str());
+	}
+	summary += "]}";
+
+	msg("gcc_rtti summary: %s\n", summary.c_str());
+
+	if (m_options.m_summary.empty())
+	{
+		return;
+	}
+
+	FILE *const file = qfopen(m_options.m_summary.c_str(), "wb");
+	if (!file)
+	{
+		msg("Unable to open summary file %s for write!\n", m_options.m_summary.c_str());
+		return;
+	}
+
+	qfprintf(file, "%s\n", summary.c_str());
+	qfclose(file);
 }
 
 void gcc_rtti_t::initialize_segments_data()
@@ -104,47 +387,53 @@ void gcc_rtti_t::initialize_segments_data()
 			continue;
 		}
 
-		qstring segment_name;
-		get_segm_name(&segment_name, segment);
+		load_segment_data(segment);
+	}
+}
 
-		qstring segment_class;
-		get_segm_class(&segment_class, segment);
+bool gcc_rtti_t::load_segment_data(segment_t *const segment)
+{
+	qstring segment_name;
+	get_segm_name(&segment_name, segment);
 
-		if (segment_class != "DATA" && segment_class != "CONST")
-		{
-			continue;
-		}
+	qstring segment_class;
+	get_segm_class(&segment_class, segment);
 
-		segment_data_t segcode;
-		segcode.m_start_ea = segment->start_ea;
-		segcode.m_end_ea = segment->end_ea;
+	if (segment_class != "DATA" && segment_class != "CONST")
+	{
+		return false;
+	}
 
-		if (segment->start_ea == BADADDR || segment->end_ea == BADADDR)
-		{
-			warning("Code begins/end in inproper place, begin = " ADDR_FORMAT "; end = " ADDR_FORMAT, segment->start_ea, segment->end_ea);
-			continue;
-		}
+	segment_data_t segcode;
+	segcode.m_start_ea = segment->start_ea;
+	segcode.m_end_ea = segment->end_ea;
 
-		if ((segment->end_ea - segment->start_ea) > 100 * 1024 * 1024) // 100 MB limit
-		{
-			warning
-			(
-				"Segment (%s) data size exceeds limit of 100 MB (%u MB) [ " ADDR_FORMAT " - " ADDR_FORMAT " ]",
-				segment_name.c_str(),
-				static_cast<uint>((segment->end_ea - segment->start_ea) / 1024 / 1024),
-				segcode.m_start_ea, segcode.m_end_ea
-			);
-			continue;
-		}
+	if (segment->start_ea == BADADDR || segment->end_ea == BADADDR)
+	{
+		report("Code begins/end in inproper place, begin = " ADDR_FORMAT "; end = " ADDR_FORMAT, segment->start_ea, segment->end_ea);
+		return false;
+	}
 
-		segcode.m_data.resize(static_cast<size_t>(segcode.m_end_ea - segcode.m_start_ea));
-		if (!get_bytes(&segcode.m_data[0], segcode.m_data.size(), segcode.m_start_ea, GMB_READALL))
-		{
-			warning("get_bytes() returned failure, expect problems.. [" ADDR_FORMAT " - " ADDR_FORMAT "]", segcode.m_start_ea, segcode.m_end_ea);
-		}
+	if ((segment->end_ea - segment->start_ea) > 100 * 1024 * 1024) // 100 MB limit
+	{
+		report
+		(
+			"Segment (%s) data size exceeds limit of 100 MB (%u MB) [ " ADDR_FORMAT " - " ADDR_FORMAT " ]",
+			segment_name.c_str(),
+			static_cast<uint>((segment->end_ea - segment->start_ea) / 1024 / 1024),
+			segcode.m_start_ea, segcode.m_end_ea
+		);
+		return false;
+	}
 
-		m_segments_data.push_back(segcode);
+	segcode.m_data.resize(static_cast<size_t>(segcode.m_end_ea - segcode.m_start_ea));
+	if (!get_bytes(&segcode.m_data[0], segcode.m_data.size(), segcode.m_start_ea, GMB_READALL))
+	{
+		report("get_bytes() returned failure, expect problems.. [" ADDR_FORMAT " - " ADDR_FORMAT "]", segcode.m_start_ea, segcode.m_end_ea);
 	}
+
+	m_segments_data.push_back(segcode);
+	return true;
 }
 
 ea_t gcc_rtti_t::find_string(const string s) const
@@ -161,25 +450,35 @@ ea_t gcc_rtti_t::find_string(const string s) const
 
 void gcc_rtti_t::find_type_info(const ti_types_t idx)
 {
-	const ea_t address = find_string(ti_names[idx]);
-	if (address == BADADDR)
+	ea_t ti_start = m_symbols ? m_symbols->find_type_info(ti_kinds[idx].m_name) : BADADDR;
+	if (ti_start == BADADDR)
 	{
-		return;
-	}
+		ea_t address = m_symbols ? m_symbols->find_type_name(ti_kinds[idx].m_name) : BADADDR;
+		if (address == BADADDR)
+		{
+			address = find_string(ti_kinds[idx].m_name);
+		}
 
-	utils::xreferences_t xrefs = utils::xref_or_find(address);
-	if (xrefs.empty())
-	{
-		return;
+		if (address == BADADDR)
+		{
+			return;
+		}
+
+		utils::xreferences_t xrefs = utils::xref_or_find(address);
+		if (xrefs.empty())
+		{
+			return;
+		}
+
+		ti_start = xrefs[0].m_address - sizeof(ea_t);
 	}
 
-	const ea_t ti_start = xrefs[0].m_address - sizeof(ea_t);
 	if (utils::is_bad_addr(ti_start))
 	{
 		return;
 	}
 
-	printf("found %d at " ADDR_FORMAT "\n", static_cast<int>(idx), ti_start);
+	log("found %d at " ADDR_FORMAT "\n", static_cast<int>(idx), ti_start);
 	const ea_t ea = format_type_info(ti_start);
 	if (idx >= TI_CTINFO)
 	{
@@ -187,98 +486,249 @@ void gcc_rtti_t::find_type_info(const ti_types_t idx)
 	}
 }
 
-void gcc_rtti_t::handle_classes(ti_types_t idx, ea_t(gcc_rtti_t::*const formatter)(const ea_t address))
+void gcc_rtti_t::handle_type_infos()
 {
-	sstring_t name = vtname(ti_names[idx]);
+	// with symbols_only type infos without symbol are not looked for in data at all
+	const bool scan = !m_symbols || m_options.m_symbols != options_t::SYMBOLS_ONLY;
 
-	// try single underscore first
-	ea_t address = get_name_ea(BADADDR, &name[1]);
-	if (address != BADADDR)
-	{
-		name = &name[1];
-	}
-	else
+	array_dyn_t<ea_t> candidates[TI_COUNT];
+	array_dyn_t<std::pair<ea_t, ti_types_t>> address_points; // of vtables of all kinds
+
+	for (int i = TI_CTINFO; i < TI_COUNT; ++i)
 	{
-		address = get_name_ea(BADADDR, &name[0]);
+		const ti_types_t type = static_cast<ti_types_t>(i);
+		sstring_t name = vtname(ti_kinds[type].m_name);
+
+		// try single underscore first
+		ea_t address = get_name_ea(BADADDR, &name[1]);
+		if (address != BADADDR)
+		{
+			name = &name[1];
+		}
+		else
+		{
+			address = get_name_ea(BADADDR, &name[0]);
+		}
+
+		if (address == BADADDR)
+		{
+			log("Could not find vtable for %s\n", ti_kinds[type].m_name);
+			continue;
+		}
+
+		int suffix = 0;
+		while (address != BADADDR)
+		{
+			log("Looking for refs to vtable " ADDR_FORMAT "\n", address);
+
+			if (is_spec_ea(address) && !m_fixups_only && scan)
+			{
+				for (const utils::xreference_t &xref : utils::xref_or_find(address, true))
+				{
+					candidates[type].push_back(xref.m_address);
+				}
+			}
+
+			address += sizeof(ea_t) * 2; // We are looking for +8(32)/+16(64) offset to type vtable
+			m_ti_vtables[type].push_back(address);
+			address_points.push_back(std::make_pair(address, type));
+
+			sstring_t name2; name2.sprnt("%s_%d", name.c_str(), suffix++);
+			address = get_name_ea(BADADDR, name2.c_str());
+		}
 	}
 
-	if (address == BADADDR)
+	if (address_points.empty())
 	{
-		printf("Could not find vtable for %s\n", ti_names[idx]);
 		return;
 	}
 
-	idx = TI_TINFO;
-	utils::xreferences_t xrefs;
-	xrefs.reserve(100); // just for optimization
-	map_t<ea_t, bool> handled;
+	std::sort(address_points.begin(), address_points.end());
 
-	while (address != BADADDR)
+	const auto find_type = [&address_points](const ea_t value) -> ti_types_t
 	{
-		xrefs.clear();
-
-		printf("Looking for refs to vtable " ADDR_FORMAT "\n", address);
+		const auto found = std::lower_bound(address_points.begin(), address_points.end(), std::make_pair(value, TI_TINFO));
+		return (found != address_points.end() && found->first == value) ? found->second : TI_COUNT;
+	};
 
-		if (is_spec_ea(address))
+	const auto parse_candidates = [this](array_dyn_t<ea_t> (&candidates)[TI_COUNT], rangeset_t &parsed)
+	{
+		// classes are parsed before other kinds, so pointers to them refer named type infos
+		for (int i = TI_CTINFO; i < TI_COUNT; ++i)
 		{
-			xrefs = utils::xref_or_find(address, true);
+			const ti_types_t type = static_cast<ti_types_t>(i);
+			array_dyn_t<ea_t> &addresses = candidates[type];
+
+			std::sort(addresses.begin(), addresses.end());
+			addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+
+			log("Looking for %s\n", ti_kinds[type].m_description);
+
+			for (const ea_t address : addresses)
+			{
+				if (utils::is_bad_addr(address) || parsed.has(address))
+				{
+					continue;
+				}
+
+				log("found %s at " ADDR_FORMAT "\n", ti_kinds[type].m_name, address);
+				const ea_t end = parse_type_info(type, address);
+				parsed.add(range_t(address, (end == BADADDR || end <= address) ? address + sizeof(ea_t) * 2 : end));
+			}
+			addresses.clear();
 		}
+	};
 
-		address += sizeof(ea_t) * 2; // We are looking for +8(32)/+16(64) offset to type vtable
+	rangeset_t parsed; // records of type infos which have been parsed already
 
-		for (const segment_data_t &segment_data : m_segments_data)
+	if (m_symbols)
+	{
+		// named type infos are taken first, scans below only add the ones without symbol
+		for (const ea_t type_info : m_symbols->get_type_infos())
 		{
-			for (size_t current = 0; current < segment_data.m_data.size() - sizeof(ea_t); current += sizeof(ea_t))
+			const ti_types_t type = find_type(get_pointer(type_info));
+			if (type != TI_COUNT)
 			{
-				if (*reinterpret_cast<const ea_t *>(&segment_data.m_data[current]) != address
-				 || is_code(get_flags(segment_data.m_start_ea + current)))
+				candidates[type].push_back(type_info);
+			}
+		}
+		parse_candidates(candidates, parsed);
+	}
+
+	if (scan && m_fixups)
+	{
+		// references are taken straight from relocations, with fixups discovery there is no need to scan data
+		array_dyn_t<ea_t> sources;
+		for (const auto &address_point : address_points)
+		{
+			sources.clear();
+			m_fixups->find_sources(address_point.first, sources);
+
+			for (const ea_t source : sources)
+			{
+				const segment_data_t *const segment_data = find_segment_data(source);
+				if (segment_data && !parsed.has(source) && is_type_info_candidate(*segment_data, static_cast<size_t>(source - segment_data->m_start_ea)))
 				{
-					continue;
+					candidates[address_point.second].push_back(source);
 				}
+			}
+		}
+	}
 
-				const ea_t next_ea = *reinterpret_cast<const ea_t *>(&segment_data.m_data[current + sizeof(ea_t)]);
+	if (scan && !m_fixups_only)
+	{
+		// single pass for all kinds, most of values are rejected by range of address points
+		const ea_t lowest = address_points.front().first;
+		const ea_t highest = address_points.back().first;
 
-				if (is_code(get_flags(next_ea)))
+		const auto scan_words = [&](const segment_data_t &segment_data, size_t current, const size_t end)
+		{
+			for (current = (current + sizeof(ea_t) - 1) & ~(sizeof(ea_t) - 1); current + sizeof(ea_t) * 2 <= end; current += sizeof(ea_t))
+			{
+				const ea_t value = *reinterpret_cast<const ea_t *>(&segment_data.m_data[current]);
+				if (value < lowest || value > highest)
 				{
 					continue;
 				}
 
-				sstring_t mangled_name = utils::get_string(next_ea);
-				if (mangled_name[0] == '\0' || mangled_name[0] == -1) { continue; }
-				if (mangled_name[0] == '*') { mangled_name = &mangled_name[1]; }
-				if (detect_compiler_using_demangler((sstring_t("_ZTV") + mangled_name).c_str()) <= 0)
+				const ti_types_t type = find_type(value);
+				if (type != TI_COUNT && is_type_info_candidate(segment_data, current))
+				{
+					candidates[type].push_back(segment_data.m_start_ea + current);
+				}
+			}
+		};
+
+		for (const segment_data_t &segment_data : m_segments_data)
+		{
+			// only gaps between records of type infos found by symbols are scanned
+			const size_t size = segment_data.m_data.size();
+			size_t current = 0;
+
+			for (const range_t &range : parsed)
+			{
+				if (range.end_ea <= segment_data.m_start_ea || range.start_ea >= segment_data.m_start_ea + size)
 				{
 					continue;
 				}
 
-				xrefs.push_back(utils::xreference_t(segment_data.m_start_ea + current, false));
+				const size_t start = range.start_ea > segment_data.m_start_ea ? static_cast<size_t>(range.start_ea - segment_data.m_start_ea) : 0;
+				scan_words(segment_data, current, std::min(size, start + sizeof(ea_t)));	// last candidate reads first word of record
+				current = std::max(current, static_cast<size_t>(range.end_ea - segment_data.m_start_ea));
 			}
+			scan_words(segment_data, current, size);
 		}
+	}
+
+	parse_candidates(candidates, parsed);
+}
+
+bool gcc_rtti_t::is_type_info_candidate(const segment_data_t &segment_data, const size_t current) const
+{
+	// vtable pointer followed by pointer to mangled name
+	if (current + sizeof(ea_t) * 2 > segment_data.m_data.size()
+	 || is_code(get_flags(segment_data.m_start_ea + current)))
+	{
+		return false;
+	}
+
+	const ea_t next_ea = m_fixups
+		? get_pointer(segment_data.m_start_ea + current + sizeof(ea_t))
+		: *reinterpret_cast<const ea_t *>(&segment_data.m_data[current + sizeof(ea_t)]);
+
+	if (is_code(get_flags(next_ea)))
+	{
+		return false;
+	}
+
+	sstring_t mangled_name = utils::get_string(next_ea);
+	if (mangled_name[0] == '\0' || mangled_name[0] == -1) { return false; }
+	if (mangled_name[0] == '*') { mangled_name = &mangled_name[1]; }
+	return detect_compiler_using_demangler((sstring_t("_ZTV") + mangled_name).c_str()) > 0;
+}
 
-		for (const utils::xreference_t &xref : xrefs)
+auto gcc_rtti_t::get_type_info_type(const ea_t vtable) const -> ti_types_t
+{
+	for (int type = TI_CTINFO; type < TI_COUNT; ++type)
+	{
+		for (const ea_t address : m_ti_vtables[type])
 		{
-			if (utils::is_bad_addr(xref.m_address) || handled.find(xref.m_address) != handled.end())
+			if (address == vtable)
 			{
-				continue;
+				return static_cast<ti_types_t>(type);
 			}
-
-			printf("found %s at " ADDR_FORMAT "\n", name.c_str(), xref.m_address);
-			(this->*formatter)(xref.m_address);
-			handled[xref.m_address] = true;
 		}
+	}
+	return TI_COUNT;
+}
+
+ea_t gcc_rtti_t::parse_type_info(const ti_types_t type, const ea_t address)
+{
+	const ti_kind_t &kind = ti_kinds[type];
 
-		sstring_t name2; name2.sprnt("%s_%d", name.c_str(), static_cast<int>(idx));
-		address = get_name_ea(BADADDR, name2.c_str());
-		idx = static_cast<ti_types_t>(static_cast<int>(idx) + 1);
+	ea_t end = (this->*kind.m_formatter)(address);
+	if (end != BADADDR && kind.m_layout[0] != '\0')
+	{
+		end = format_struct(end, kind.m_layout);
+	}
+
+	if (!kind.m_class)
+	{
+		return end;
 	}
+
+	// remember extent of type info, so changes inside of it can be detected
+	class_t *const c = get_class(address);
+	c->m_ti_end = (end == BADADDR || end < address + sizeof(ea_t) * 2) ? address + sizeof(ea_t) * 2 : end;
+	return c->m_ti_end;
 }
 
-ea_t gcc_rtti_t::format_type_info(const ea_t address)
+ea_t gcc_rtti_t::format_type_header(const ea_t address, sstring_t &mangled_name)
 {
 	// dd `vtable for'std::type_info+8
 	// dd `typeinfo name for'std::type_info
 
-	const ea_t tis = utils::get_ea(address + sizeof(ea_t));
+	const ea_t tis = get_pointer(address + sizeof(ea_t));
 	if (utils::is_bad_addr(tis))
 	{
 		return BADADDR;
@@ -292,53 +742,142 @@ ea_t gcc_rtti_t::format_type_info(const ea_t address)
 	}	
 
 	/* skip '*' character in case of type defined in function */
-	const sstring_t proper_name = (name[0] == '*' ? name.c_str() + 1 : name.c_str());
+	mangled_name = (name[0] == '*' ? name.c_str() + 1 : name.c_str());
 
 	// looks good, let's do it
 	const ea_t address2 = format_struct(address, "vp");
-	set_name(tis, (sstring_t("__ZTS") + proper_name).c_str(), SN_NOWARN);
-	set_name(address, (sstring_t("__ZTI") + proper_name).c_str(), SN_NOWARN);
+	apply_name(tis, sstring_t("__ZTS") + mangled_name);
+	apply_name(address, sstring_t("__ZTI") + mangled_name);
+	return address2;
+}
 
-	qstring demangled_name;
-	if(demangle_name(&demangled_name, (sstring_t("_Z") + proper_name).c_str(), 0) >= 0)
-	{
-		get_class(address)->m_name = demangled_name;
-	}
-	else
+ea_t gcc_rtti_t::format_plain_type_info(const ea_t address)
+{
+	// type info which does not describe class, fields following the name are formatted by layout of its kind
+	sstring_t mangled_name;
+	return format_type_header(address, mangled_name);
+}
+
+ea_t gcc_rtti_t::format_type_info(const ea_t address)
+{
+	sstring_t proper_name;
+	const ea_t address2 = format_type_header(address, proper_name);
+	if (address2 == BADADDR)
 	{
-		get_class(address)->m_name = name;
+		return BADADDR;
 	}
 
-	ea_t vtb = BADADDR;
+	class_t *const c = get_class(address);
+	c->m_mangled_name = proper_name;
+	m_classes_by_name.emplace(utils::hash_string(proper_name.c_str()), c);
 
-	// find our vtable
-	// 0 followed by ea
-	for (const segment_data_t &segment_data : m_segments_data)
+	// library class, name is taken from database
+	const uint32 known_entry = m_known_types ? m_known_types->find(proper_name.c_str()) : known_types_t::NO_ENTRY;
+	if (known_entry != known_types_t::NO_ENTRY)
 	{
-		for (size_t current = sizeof(ea_t); current < segment_data.m_data.size(); current += sizeof(ea_t))
-		{
-			if (*reinterpret_cast<const ea_t *>(&segment_data.m_data[current - sizeof(ea_t)]) != 0 // following 0
-			 || *reinterpret_cast<const ea_t *>(&segment_data.m_data[current]) != address)
-			{
-				continue;
-			}
+		c->m_known = true;
+		c->m_name = m_known_types->get_string(m_known_types->get_entry(known_entry).m_demangled);
 
-			vtb = segment_data.m_start_ea + current;
+		if (m_options.m_known_types_fill)
+		{
+			m_known_pending.push_back(std::make_pair(c, known_entry));
+		}
+	}
+	else
+	{
+		qstring demangled_name;
+		if(demangle_name(&demangled_name, (sstring_t("_Z") + proper_name).c_str(), 0) >= 0)
+		{
+			c->m_name = demangled_name;
+		}
+		else
+		{
+			c->m_name = proper_name;
 		}
 	}
 
-	if (!utils::is_bad_addr(vtb))
+	// vtable found before (i.e. when type info is parsed again after change) does not have to be searched again,
+	// only indexed lookups are done here, the rest is found for all classes at once by resolve_pending_vtables()
+	ea_t vtb = c->m_vtable;
+	if ((utils::is_bad_addr(vtb) || !is_vtable_of(vtb, address)) && m_symbols)
+	{
+		vtb = find_vtable_symbol(proper_name, address);
+	}
+
+	if ((utils::is_bad_addr(vtb) || !is_vtable_of(vtb, address)) && m_fixups)
 	{
-		printf("vtable for %s at " ADDR_FORMAT "\n", proper_name.c_str(), vtb);
-		format_struct(vtb, "pp");
-		set_name(vtb, (sstring_t("__ZTV") + proper_name).c_str(), SN_NOWARN);
+		vtb = find_vtable_fixups(address);
+	}
+
+	if (!utils::is_bad_addr(vtb) && is_vtable_of(vtb, address))
+	{
+		format_vtable(c, vtb);
 	}
 	else
+	{
+		m_pending_vtables.push_back(c);
+	}
+	return address2;
+}
+
+ea_t gcc_rtti_t::find_vtable_fixups(const ea_t address) const
+{
+	ea_t vtb = BADADDR;
+
+	array_dyn_t<ea_t> sources;
+	m_fixups->find_sources(address, sources);
+
+	for (const ea_t source : sources)
+	{
+		if (utils::get_ea(source - sizeof(ea_t)) == 0) // following 0
+		{
+			vtb = source;
+		}
+	}
+	return vtb;
+}
+
+ea_t gcc_rtti_t::find_vtable_symbol(const sstring_t &mangled_name, const ea_t address) const
+{
+	const ea_t symbol = m_symbols->find_vtable(mangled_name.c_str());
+	if (symbol == BADADDR)
 	{
 		return BADADDR;
 	}
 
-	return address2;
+	// _ZTV symbol points to offset to top, name made by plugin points to type info pointer
+	if (is_vtable_of(symbol + sizeof(ea_t), address))
+	{
+		return symbol + sizeof(ea_t);
+	}
+	return is_vtable_of(symbol, address) ? symbol : BADADDR;
+}
+
+ea_t gcc_rtti_t::get_pointer(const ea_t address) const
+{
+	// relocation target is preferred, pointer itself may be zero or point to extern
+	if (m_fixups)
+	{
+		const ea_t target = m_fixups->get_target(address);
+		if (target != BADADDR)
+		{
+			return target;
+		}
+	}
+	return utils::get_ea(address);
+}
+
+bool gcc_rtti_t::is_vtable_of(const ea_t vtable, const ea_t address) const
+{
+	return get_pointer(vtable) == address && utils::get_ea(vtable - sizeof(ea_t)) == 0;
+}
+
+void gcc_rtti_t::format_vtable(class_t *const c, const ea_t vtable)
+{
+	log("vtable for %s at " ADDR_FORMAT "\n", c->m_mangled_name.c_str(), vtable);
+	c->m_vtable = vtable;
+	format_struct(vtable, "pp");
+	apply_name(vtable, sstring_t("__ZTV") + c->m_mangled_name);
 }
 
 ea_t gcc_rtti_t::format_si_type_info(const ea_t address)
@@ -348,7 +887,12 @@ ea_t gcc_rtti_t::format_si_type_info(const ea_t address)
 	// dd `typeinfo for'BaseClass
 
 	const ea_t addr = format_type_info(address);
-	const ea_t pbase = utils::get_ea(addr);
+	if (has_known_bases(address))
+	{
+		return addr;
+	}
+
+	const ea_t pbase = get_pointer(addr);
 	get_class(address)->add_base(class_t::base_t(get_class(pbase)));
 	return format_struct(addr, "p");
 }
@@ -362,7 +906,7 @@ ea_t gcc_rtti_t::format_vmi_type_info(const ea_t address)
 	// (base_type, offset_flags) x base_count
 
 	ea_t addr = format_type_info(address);
-	if (addr == BADADDR)
+	if (addr == BADADDR || has_known_bases(address))
 	{
 		return address;
 	}
@@ -372,13 +916,13 @@ ea_t gcc_rtti_t::format_vmi_type_info(const ea_t address)
 	const uint32_t base_count = get_32bit(addr - sizeof(uint32_t));
 	if (base_count > 100)
 	{
-		printf(ADDR_FORMAT ": over 100 base classes (%u)(" ADDR_FORMAT ")?!\n", address, base_count, static_cast<ea_t>(addr - sizeof(uint32_t)));
+		log(ADDR_FORMAT ": over 100 base classes (%u)(" ADDR_FORMAT ")?!\n", address, base_count, static_cast<ea_t>(addr - sizeof(uint32_t)));
 		return BADADDR;
 	}
 
 	for (uint32_t i = 0; i < base_count; ++i)
 	{
-		const ea_t base_ti = utils::get_ea(addr);
+		const ea_t base_ti = get_pointer(addr);
 		const ea_t flags_off = utils::get_ea(addr + sizeof(ea_t));
 		const ea_t off = utils::sig_next(flags_off >> 8, 24);
 
@@ -390,6 +934,767 @@ ea_t gcc_rtti_t::format_vmi_type_info(const ea_t address)
 	return addr;
 }
 
+void gcc_rtti_t::update(const rangeset_t &dirty, const rangeset_t &dirty_segments, rangeset_t &touched)
+{
+	if (!m_hierarchy)
+	{
+		return; // plugin has not been run yet
+	}
+
+	for (size_t i = 0; i < dirty_segments.nranges(); ++i)
+	{
+		reload_segments_data(dirty_segments.getrange(static_cast<int>(i)));
+	}
+
+	map_t<ea_t, ti_types_t> type_infos;	// valid type infos in changed ranges
+	map_t<ea_t, bool> affected;			// already parsed type infos which overlap changed ranges
+	map_t<ea_t, ea_t> vtables;			// vtables in changed ranges -> type info
+
+	for (size_t i = 0; i < dirty.nranges(); ++i)
+	{
+		collect_changes(dirty.getrange(static_cast<int>(i)), type_infos, affected, vtables);
+	}
+
+	for (size_t i = 0; i < dirty_segments.nranges(); ++i)
+	{
+		collect_changes(dirty_segments.getrange(static_cast<int>(i)), type_infos, affected, vtables);
+	}
+
+	if (type_infos.empty() && affected.empty() && vtables.empty())
+	{
+		return;
+	}
+
+	array_dyn_t<ea_t> removed;
+	for (const auto &affected_pair : affected)
+	{
+		if (type_infos.find(affected_pair.first) == type_infos.end())
+		{
+			removed.push_back(affected_pair.first);
+		}
+	}
+
+	// removed classes are kept alive until hierarchy has dropped them
+	classes_t removed_classes;
+	remove_classes(removed, removed_classes);
+
+	for (const auto &type_info_pair : type_infos)
+	{
+		const auto found = m_classes.find(type_info_pair.first);
+		if (found != m_classes.end() && found->second)
+		{
+			found->second->m_bases.clear();
+		}
+		parse_type_info(type_info_pair.second, type_info_pair.first);
+	}
+
+	// new classes and classes with bases parsed again, bases created meanwhile are picked up by hierarchy
+	array_dyn_t<class_t *> changed;
+	for (const auto &type_info_pair : type_infos)
+	{
+		const auto found = m_classes.find(type_info_pair.first);
+		if (found == m_classes.end() || !found->second)
+		{
+			continue;
+		}
+
+		class_t *const c = found->second.get();
+		changed.push_back(c);
+
+		// formatting of type info makes auto analysis create data later, it must not be parsed again
+		if (c->m_ti_end != BADADDR)
+		{
+			touched.add(range_t(c->m_address, c->m_ti_end));
+		}
+		const ea_t name = get_pointer(c->m_address + sizeof(ea_t));
+		if (!utils::is_bad_addr(name))
+		{
+			touched.add(range_t(name, name + 1));
+		}
+	}
+
+	resolve_known_bases();
+
+	// no scan of whole data here, vtables not found by symbol or fixup are taken from changed ranges below
+	m_pending_vtables.clear();
+
+	for (const auto &vtable_pair : vtables)
+	{
+		const auto found = m_classes.find(vtable_pair.second);
+		if (found != m_classes.end() && found->second && found->second->m_vtable != vtable_pair.first)
+		{
+			format_vtable(found->second.get(), vtable_pair.first);
+			touched.add(range_t(vtable_pair.first - sizeof(ea_t), vtable_pair.first + sizeof(ea_t) * 2));
+		}
+	}
+
+	array_dyn_t<class_t *> removed_pointers;
+	for (const auto &class_pair : removed_classes)
+	{
+		removed_pointers.push_back(class_pair.second.get());
+	}
+
+	if (!m_hierarchy->update(changed, removed_pointers))
+	{
+		m_hierarchy->build(m_classes);
+	}
+
+	// old labels of vtable slots do not match hierarchy anymore, they are built again when needed
+	m_overrides.reset();
+
+	// exported files are written again by refresh_outputs(), once changes stop coming
+	m_outputs_stale = m_graph != nullptr;
+
+	msg("Class informer: %u type infos parsed again, %u removed, %u vtables found, %u classes in total\n",
+		static_cast<uint>(type_infos.size()), static_cast<uint>(removed.size()),
+		static_cast<uint>(vtables.size()), static_cast<uint>(m_classes.size()));
+}
+
+void gcc_rtti_t::refresh_outputs()
+{
+	if (m_outputs_stale && m_graph)
+	{
+		m_graph->refresh();
+	}
+	m_outputs_stale = false;
+}
+
+void gcc_rtti_t::reload_segments_data(const range_t &range)
+{
+	// data of segments which were moved or added in this range is not valid anymore
+	m_segments_data.erase(std::remove_if(
+		m_segments_data.begin(), m_segments_data.end(),
+		[&range](const segment_data_t &segment_data)
+		{
+			return segment_data.m_start_ea < range.end_ea && range.start_ea < segment_data.m_end_ea;
+		}
+	), m_segments_data.end());
+
+	segment_t *segment = getseg(range.start_ea);
+	if (!segment)
+	{
+		segment = get_next_seg(range.start_ea);
+	}
+
+	for (; segment && segment->start_ea < range.end_ea; segment = get_next_seg(segment->start_ea))
+	{
+		if (!find_segment_data(segment->start_ea))
+		{
+			load_segment_data(segment);
+		}
+	}
+}
+
+void gcc_rtti_t::collect_changes(const range_t &range, map_t<ea_t, ti_types_t> &type_infos, map_t<ea_t, bool> &affected, map_t<ea_t, ea_t> &vtables)
+{
+	for (segment_data_t &segment_data : m_segments_data)
+	{
+		const ea_t start = std::max(range.start_ea, segment_data.m_start_ea);
+		const ea_t end = std::min(range.end_ea, segment_data.m_end_ea);
+		if (start >= end)
+		{
+			continue;
+		}
+
+		const size_t first_changed = static_cast<size_t>(start - segment_data.m_start_ea);
+		const size_t last_changed = static_cast<size_t>(end - segment_data.m_start_ea);
+
+		get_bytes(&segment_data.m_data[first_changed], last_changed - first_changed, start, GMB_READALL);
+
+		// type info begins at most two pointers before changed byte (vtable pointer and name pointer),
+		// vtable one pointer before it (zero offset to top)
+		size_t current = first_changed / sizeof(ea_t) * sizeof(ea_t);
+		current = current > sizeof(ea_t) * 2 ? current - sizeof(ea_t) * 2 : 0;
+
+		for (; current < last_changed && current + sizeof(ea_t) <= segment_data.m_data.size(); current += sizeof(ea_t))
+		{
+			const ea_t value = *reinterpret_cast<const ea_t *>(&segment_data.m_data[current]);
+			const ea_t address = segment_data.m_start_ea + current;
+
+			const ti_types_t type = get_type_info_type(value);
+			if (type != TI_COUNT && ti_kinds[type].m_class && is_type_info_candidate(segment_data, current))
+			{
+				type_infos[address] = type;
+			}
+
+			if (current >= sizeof(ea_t) && *reinterpret_cast<const ea_t *>(&segment_data.m_data[current - sizeof(ea_t)]) == 0)
+			{
+				const auto found = m_classes.find(value);
+				if (found != m_classes.end() && found->second && !found->second->m_mangled_name.empty())
+				{
+					vtables[address] = value;
+				}
+			}
+		}
+	}
+
+	// already parsed type infos which start before range may reach into it (i.e. bases of vmi)
+	const ea_t window_start = range.start_ea > MAX_TYPE_INFO_SIZE ? range.start_ea - MAX_TYPE_INFO_SIZE : 0;
+
+	for (auto it = m_classes.lower_bound(window_start); it != m_classes.end() && it->first < range.end_ea; ++it)
+	{
+		if (!it->second || it->second->m_ti_end == BADADDR || it->second->m_ti_end <= range.start_ea)
+		{
+			continue;
+		}
+
+		affected[it->first] = true;
+
+		// check again whether it is still valid type info
+		const segment_data_t *const segment_data = find_segment_data(it->first);
+		if (!segment_data)
+		{
+			continue;
+		}
+
+		const size_t current = static_cast<size_t>(it->first - segment_data->m_start_ea);
+		if (current + sizeof(ea_t) > segment_data->m_data.size())
+		{
+			continue;
+		}
+
+		const ti_types_t type = get_type_info_type(*reinterpret_cast<const ea_t *>(&segment_data->m_data[current]));
+		if (type != TI_COUNT && ti_kinds[type].m_class && is_type_info_candidate(*segment_data, current))
+		{
+			type_infos[it->first] = type;
+		}
+	}
+}
+
+void gcc_rtti_t::remove_classes(const array_dyn_t<ea_t> &addresses, classes_t &removed)
+{
+	// firstly unlink removed classes from derived ones, hierarchy is still valid at this point
+	for (const ea_t address : addresses)
+	{
+		const auto found = m_classes.find(address);
+		if (found == m_classes.end() || !found->second)
+		{
+			continue;
+		}
+
+		const class_t *const removed = found->second.get();
+
+		array_dyn_t<class_t *> derived;
+		m_hierarchy->get_derived(removed, derived);
+
+		for (class_t *const c : derived)
+		{
+			c->m_bases.erase(std::remove_if(
+				c->m_bases.begin(), c->m_bases.end(),
+				[removed](const class_t::base_t &base)
+				{
+					return base.m_class == removed;
+				}
+			), c->m_bases.end());
+		}
+	}
+
+	for (const ea_t address : addresses)
+	{
+		log("type info at " ADDR_FORMAT " is not valid anymore\n", address);
+
+		const auto found = m_classes.find(address);
+		if (found != m_classes.end() && found->second)
+		{
+			const auto by_name = m_classes_by_name.find(utils::hash_string(found->second->m_mangled_name.c_str()));
+			if (by_name != m_classes_by_name.end() && by_name->second == found->second.get())
+			{
+				m_classes_by_name.erase(by_name);
+			}
+			removed.emplace(address, std::move(found->second));
+		}
+		m_classes.erase(address);
+	}
+}
+
+auto gcc_rtti_t::find_segment_data(const ea_t address) const -> const segment_data_t *
+{
+	for (const segment_data_t &segment_data : m_segments_data)
+	{
+		if (address >= segment_data.m_start_ea && address < segment_data.m_end_ea)
+		{
+			return &segment_data;
+		}
+	}
+	return nullptr;
+}
+
+void gcc_rtti_t::handle_vtables()
+{
+	vtables_t detector;
+	detector.build(m_segments_data);
+
+	const array_dyn_t<vtables_t::vtable_t> &vtables = detector.get_vtables();
+
+	// only primary vtables make classes, secondary ones give bases at their offsets
+	uint classes_count = 0;
+	for (const vtables_t::vtable_t &vtable : vtables)
+	{
+		if (vtable.m_offset_to_top != 0)
+		{
+			continue;
+		}
+
+		class_t *const c = get_class(vtable.m_address);
+		c->m_vtable = vtable.m_address;
+		c->m_inferred = true;
+		++classes_count;
+
+		// _ZTV symbol is at offset to top, one word before type info pointer
+		const ea_t symbol = vtable.m_address - sizeof(ea_t);
+		if (!get_vtable_symbol_class(symbol, c->m_name))
+		{
+			c->m_name.sprnt("class_%a", vtable.m_address);
+			apply_name(vtable.m_address, sstring_t("vtable_") + c->m_name);
+		}
+
+		format_struct(vtable.m_address - sizeof(ea_t), "pp");
+		log("vtable for %s at " ADDR_FORMAT " (%u slots)\n", c->m_name.c_str(), vtable.m_address, vtable.m_slot_count);
+	}
+
+	for (const vtables_t::vtable_t &vtable : vtables)
+	{
+		if (vtable.m_primary == vtables_t::NO_INDEX || vtable.m_parent == vtables_t::NO_INDEX)
+		{
+			continue;
+		}
+
+		class_t *const c = get_class(vtables[vtable.m_primary].m_address);
+		class_t *const base = get_class(vtables[vtable.m_parent].m_address);
+
+		const bool exists = std::any_of(c->m_bases.begin(), c->m_bases.end(), [base](const class_t::base_t &b)
+		{
+			return b.m_class == base;
+		});
+
+		if (c != base && !exists)
+		{
+			c->add_base(class_t::base_t(base, static_cast<uint>(-vtable.m_offset_to_top), class_t::base_t::FLAG_PUBLIC));
+		}
+	}
+
+	log("found %u vtables without type info, %u classes\n", static_cast<uint>(vtables.size()), classes_count);
+}
+
+bool gcc_rtti_t::get_vtable_symbol_class(const ea_t symbol, sstring_t &class_name) const
+{
+	qstring name;
+	if (!has_user_name(get_flags(symbol)) || get_ea_name(&name, symbol) <= 0)
+	{
+		return false;
+	}
+
+	// mangled name may have more leading underscores (i.e. __ZTV on Mach-O)
+	const char *text = name.c_str();
+	while (text[0] == '_' && text[1] == '_')
+	{
+		++text;
+	}
+
+	if (strncmp(text, "_ZTV", 4) != 0)
+	{
+		return false;
+	}
+
+	// vtable for class is _ZTV followed by mangled type of class
+	const sstring_t type_name(text + 4);
+	qstring demangled_name;
+	if (demangle_name(&demangled_name, (sstring_t("_Z") + type_name).c_str(), 0) >= 0)
+	{
+		class_name = demangled_name;
+	}
+	else
+	{
+		class_name = type_name;
+	}
+	return true;
+}
+
+bool gcc_rtti_t::diff_snapshot()
+{
+	snapshot_t current;
+	current.collect(*this);
+
+	snapshot_t::diff_t diff;
+	m_snapshot->compare(current, m_options.m_port_names, m_options.m_dry_run, diff);
+
+	msg("Class informer: compared with %u classes of %s: %u added, %u removed, %u changed, %u unchanged\n",
+		m_snapshot->size(), m_options.m_diff.c_str(), diff.m_added, diff.m_removed, diff.m_changed, diff.m_unchanged);
+
+	if (m_options.m_port_names)
+	{
+		msg("Class informer: ported %u names and %u comments of vtable slots\n", diff.m_ported_names, diff.m_ported_comments);
+	}
+
+	if (m_options.m_diff_report.empty() || m_options.m_dry_run)
+	{
+		return true;
+	}
+
+	FILE *const file = qfopen(m_options.m_diff_report.c_str(), "wb");
+	if (!file)
+	{
+		msg("Unable to open file %s for write!\n", m_options.m_diff_report.c_str());
+		return false;
+	}
+
+	qfprintf(file, "# %u added, %u removed, %u changed, %u unchanged\n", diff.m_added, diff.m_removed, diff.m_changed, diff.m_unchanged);
+	for (const sstring_t &line : diff.m_report)
+	{
+		qfprintf(file, "%s\n", line.c_str());
+	}
+	qfclose(file);
+
+	m_outputs.push_back(m_options.m_diff_report);
+	return true;
+}
+
+void gcc_rtti_t::apply_overrides()
+{
+	log("Labeling vtable slots\n");
+	const overrides_t *const overrides = get_overrides();
+
+	uint counts[overrides_t::SLOT_COUNT] = {};
+
+	const array_dyn_t<class_t *> &order = m_hierarchy->get_topological_order();
+	for (unsigned int index = 0; index < order.size(); ++index)
+	{
+		const class_t *const c = order[index];
+
+		for (uint32 slot = 0; slot < overrides->get_slot_count(index); ++slot)
+		{
+			const overrides_t::slot_kind_t kind = overrides->get_kind(index, slot);
+			const class_t *const origin = order[overrides->get_origin(index, slot)];
+			++counts[kind];
+
+			if (m_options.m_dry_run)
+			{
+				continue;
+			}
+
+			if (m_options.m_overrides == options_t::OVERRIDES_COMMENTS)
+			{
+				// comments given by user are kept, labels of previous run are replaced
+				const ea_t address = c->m_vtable + sizeof(ea_t) * (slot + 1);
+				qstring comment;
+				if (get_cmt(&comment, address, false) > 0 && !is_generated_comment(comment.c_str()))
+				{
+					continue;
+				}
+
+				switch (kind)
+				{
+					case overrides_t::SLOT_INTRODUCED:
+						comment.sprnt("vf%u introduced", slot);
+						break;
+					case overrides_t::SLOT_OVERRIDDEN:
+						comment.sprnt("vf%u overrides %s", slot, origin->m_name.c_str());
+						break;
+					default:
+						comment.sprnt("vf%u inherited from %s", slot, origin->m_name.c_str());
+						break;
+				}
+				set_cmt(address, comment.c_str(), false);
+			}
+			else if (kind != overrides_t::SLOT_INHERITED)
+			{
+				// method is named after the first class which defines it, names from symbols are kept
+				const ea_t target = overrides->get_target(index, slot);
+				qstring current;
+				if (!has_user_name(get_flags(target)) || (get_ea_name(&current, target) > 0 && is_generated_name(current.c_str())))
+				{
+					sstring_t name;
+					name.sprnt("%s::vf%u", c->m_name.c_str(), slot);
+					apply_name(target, utils::make_identifier(name.c_str()));
+				}
+			}
+		}
+	}
+
+	log("%u slots introduced, %u overridden, %u inherited\n",
+		counts[overrides_t::SLOT_INTRODUCED], counts[overrides_t::SLOT_OVERRIDDEN], counts[overrides_t::SLOT_INHERITED]);
+}
+
+static const char *skip_number(const char *text)
+{
+	while (*text >= '0' && *text <= '9')
+	{
+		++text;
+	}
+	return text;
+}
+
+bool gcc_rtti_t::is_generated_name(const char *const name)
+{
+	// Class__vfN by overrides, Class__ctor, Class__dtor and Class__ctor_or_dtor (_N for more of them) by structors
+	const char *suffix = nullptr;
+	for (const char *found = strstr(name, "__"); found; found = strstr(found + 1, "__"))
+	{
+		suffix = found + 2;
+	}
+
+	if (!suffix)
+	{
+		return false;
+	}
+
+	if (strncmp(suffix, "vf", 2) == 0)
+	{
+		const char *const end = skip_number(suffix + 2);
+		return end != suffix + 2 && *end == '\0';
+	}
+
+	for (const char *const kind : { "ctor_or_dtor", "ctor", "dtor" })
+	{
+		const size_t length = strlen(kind);
+		if (strncmp(suffix, kind, length) != 0)
+		{
+			continue;
+		}
+
+		const char *const rest = suffix + length;
+		if (*rest == '\0')
+		{
+			return true;
+		}
+		if (*rest == '_' && rest[1] != '\0' && *skip_number(rest + 1) == '\0')
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool gcc_rtti_t::is_generated_comment(const char *const comment)
+{
+	// vfN introduced, vfN overrides Class, vfN inherited from Class
+	if (strncmp(comment, "vf", 2) != 0)
+	{
+		return false;
+	}
+
+	const char *const rest = skip_number(comment + 2);
+	return rest != comment + 2
+		&& (strcmp(rest, " introduced") == 0 || strncmp(rest, " overrides ", 11) == 0 || strncmp(rest, " inherited from ", 16) == 0);
+}
+
+void gcc_rtti_t::handle_structors()
+{
+	structors_t structors;
+	structors.build(*this);
+
+	// more constructors (i.e. complete and base object ones) of the same class get numbered names
+	static const char *const kinds[structors_t::KIND_COUNT] = { "ctor", "dtor", "ctor_or_dtor" };
+	hash_map_t<const class_t *, uint> counts[structors_t::KIND_COUNT];
+	uint named = 0;
+
+	for (const structors_t::structor_t &structor : structors.get_structors())
+	{
+		uint &count = counts[structor.m_kind][structor.m_class];
+		const char *const kind = kinds[structor.m_kind];
+
+		sstring_t name;
+		if (count == 0)
+		{
+			name.sprnt("%s__%s", structor.m_class->m_name.c_str(), kind);
+		}
+		else
+		{
+			name.sprnt("%s__%s_%u", structor.m_class->m_name.c_str(), kind, count);
+		}
+		++count;
+
+		log("%s of %s at " ADDR_FORMAT "\n", kind, structor.m_class->m_name.c_str(), structor.m_function);
+
+		// names from symbols are kept
+		if (!has_user_name(get_flags(structor.m_function)) && apply_name(structor.m_function, utils::make_identifier(name.c_str())))
+		{
+			++named;
+		}
+	}
+
+	log("found %u constructors and destructors, %u named\n", static_cast<uint>(structors.get_structors().size()), named);
+}
+
+void gcc_rtti_t::handle_layouts()
+{
+	layouts_t layouts;
+	layouts.build(*this, *m_hierarchy);
+
+	const array_dyn_t<class_t *> &order = m_hierarchy->get_topological_order();
+	uint created = 0, existing = 0;
+
+	for (unsigned int index = 0; index < order.size(); ++index)
+	{
+		const class_t *const c = order[index];
+		if (!c)
+		{
+			continue;
+		}
+
+		size_t count = 0;
+		const layouts_t::subobject_t *const subobjects = layouts.get_layout(index, count);
+
+		const sstring_t name = utils::make_identifier(c->m_name.c_str());
+		if (get_struc_id(name.c_str()) != BADADDR)
+		{
+			++existing; // made by user or by previous run
+			continue;
+		}
+
+		if (m_options.m_dry_run)
+		{
+			continue;
+		}
+
+		const tid_t id = add_struc(BADADDR, name.c_str());
+		struc_t *const sptr = get_struc(id);
+		if (!sptr)
+		{
+			continue;
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const layouts_t::subobject_t &subobject = subobjects[i];
+			if (!subobject.m_vptr || subobject.m_offset < 0)
+			{
+				continue;
+			}
+
+			sstring_t member("__vptr");
+			if (subobject.m_class != index)
+			{
+				member += "_";
+				member += utils::make_identifier(order[subobject.m_class]->m_name.c_str());
+			}
+
+		#ifdef __EA64__
+			const flags_t flags = qword_flag();
+		#else
+			const flags_t flags = dword_flag();
+		#endif
+			if (add_struc_member(sptr, member.c_str(), subobject.m_offset, flags, nullptr, sizeof(ea_t)) != STRUC_ERROR_MEMBER_OK)
+			{
+				// the same base class more times (non-virtual diamond)
+				member.cat_sprnt("_%X", static_cast<uint>(subobject.m_offset));
+				add_struc_member(sptr, member.c_str(), subobject.m_offset, flags, nullptr, sizeof(ea_t));
+			}
+		}
+
+		// sizes of data members are unknown, so subobjects are listed in comment and only vptrs become members
+		sstring_t comment;
+		for (size_t i = 0; i < count; ++i)
+		{
+			const layouts_t::subobject_t &subobject = subobjects[i];
+			comment.cat_sprnt("%s+%X %s%s%s", i ? "\n" : "", static_cast<uint>(subobject.m_offset),
+				order[subobject.m_class]->m_name.c_str(), subobject.m_virtual ? " (virtual)" : "", subobject.m_vptr ? " vptr" : "");
+		}
+
+		set_struc_cmt(id, comment.c_str(), false);
+		++created;
+	}
+
+	log("created %u structs of class layouts, %u already existed\n", created, existing);
+}
+
+bool gcc_rtti_t::has_known_bases(const ea_t address) const
+{
+	if (!m_options.m_known_types_fill)
+	{
+		return false;
+	}
+
+	const auto found = m_classes.find(address);
+	return found != m_classes.end() && found->second && found->second->m_known;
+}
+
+void gcc_rtti_t::resolve_known_bases()
+{
+	if (m_known_pending.empty())
+	{
+		return;
+	}
+
+	log("Filling bases of %u known classes\n", static_cast<uint>(m_known_pending.size()));
+
+	for (const auto &pending : m_known_pending)
+	{
+		const known_types_t::entry_t &entry = m_known_types->get_entry(pending.second);
+
+		for (uint32 i = 0; i < entry.m_base_count; ++i)
+		{
+			const known_types_t::base_t &base = m_known_types->get_base(entry.m_first_base + i);
+			const known_types_t::entry_t &base_entry = m_known_types->get_entry(base.m_entry);
+			const string base_name = m_known_types->get_string(base_entry.m_name);
+
+			// hash is stored in database, so there is no need to compute it again
+			const auto found = m_classes_by_name.find(base_entry.m_hash);
+			if (found == m_classes_by_name.end() || found->second->m_mangled_name != base_name)
+			{
+				log("Base %s of known class %s is not present in this binary\n", base_name, pending.first->m_name.c_str());
+				continue;
+			}
+
+			pending.first->add_base(class_t::base_t(found->second, base.m_offset, base.m_flags));
+		}
+	}
+
+	m_known_pending.clear();
+}
+
+void gcc_rtti_t::resolve_pending_vtables()
+{
+	if (m_pending_vtables.empty())
+	{
+		return;
+	}
+
+	if (m_fixups_only)
+	{
+		m_pending_vtables.clear(); // relocations have been searched already
+		return;
+	}
+
+	log("Looking for vtables of %u classes\n", static_cast<uint>(m_pending_vtables.size()));
+
+	hash_map_t<ea_t, ea_t> vtables; // type info -> vtable
+	vtables.reserve(m_pending_vtables.size());
+	for (const class_t *const c : m_pending_vtables)
+	{
+		vtables.emplace(c->m_address, BADADDR);
+	}
+
+	// single scan for all of them, instead of one per class as find_vtable() does
+	for (const segment_data_t &segment_data : m_segments_data)
+	{
+		for (size_t current = sizeof(ea_t); current < segment_data.m_data.size(); current += sizeof(ea_t))
+		{
+			if (*reinterpret_cast<const ea_t *>(&segment_data.m_data[current - sizeof(ea_t)]) != 0) // following 0
+			{
+				continue;
+			}
+
+			const auto found = vtables.find(*reinterpret_cast<const ea_t *>(&segment_data.m_data[current]));
+			if (found != vtables.end())
+			{
+				found->second = segment_data.m_start_ea + current;
+			}
+		}
+	}
+
+	for (class_t *const c : m_pending_vtables)
+	{
+		const ea_t vtb = vtables[c->m_address];
+		if (!utils::is_bad_addr(vtb))
+		{
+			format_vtable(c, vtb);
+		}
+	}
+
+	m_pending_vtables.clear();
+}
+
 /**
  * p pointer
  * v vtable pointer (delta ptrsize * 2)
@@ -398,6 +1703,21 @@ ea_t gcc_rtti_t::format_vmi_type_info(const ea_t address)
  */
 ea_t gcc_rtti_t::format_struct(ea_t address, const string fmt)
 {
+	if (m_options.m_dry_run)
+	{
+		// do not touch database, just skip the struct
+		for (const char *cp = fmt; *cp; ++cp)
+		{
+			if (*cp == 'a')
+			{
+				address = (address + sizeof(ea_t) - 1) & ~static_cast<ea_t>(sizeof(ea_t) - 1);
+				continue;
+			}
+			address += (*cp == 'i') ? sizeof(int) : sizeof(ea_t);
+		}
+		return address;
+	}
+
 	for (const char *cp = fmt; *cp; ++cp)
 	{
 		const char f = *cp;
@@ -417,6 +1737,11 @@ ea_t gcc_rtti_t::format_struct(ea_t address, const string fmt)
 			create_dword(address, sizeof(int));
 			address += sizeof(int);
 		}
+		else if (f == 'a')
+		{
+			// padding before pointer which follows int on 64-bit
+			address = (address + sizeof(ea_t) - 1) & ~static_cast<ea_t>(sizeof(ea_t) - 1);
+		}
 		else if (f == 'l')
 		{
 		#ifdef __EA64__
@@ -430,6 +1755,48 @@ ea_t gcc_rtti_t::format_struct(ea_t address, const string fmt)
 	return address;
 }
 
+bool gcc_rtti_t::apply_name(const ea_t address, const sstring_t &name)
+{
+	if (m_options.m_dry_run)
+	{
+		return false;
+	}
+	return set_name(address, name.c_str(), SN_NOWARN);
+}
+
+void gcc_rtti_t::log(const char *const format, ...) const
+{
+	va_list va;
+	va_start(va, format);
+	if (m_console)
+	{
+		vprintf(format, va);
+	}
+	else
+	{
+		vmsg(format, va); // console is already closed (i.e. during update)
+	}
+	va_end(va);
+}
+
+void gcc_rtti_t::report(const char *const format, ...) const
+{
+	va_list va;
+	va_start(va, format);
+	if (m_options.m_batch)
+	{
+		// dialog would block headless run
+		sstring_t text;
+		text.vsprnt(format, va);
+		log("%s\n", text.c_str());
+	}
+	else
+	{
+		vwarning(format, va);
+	}
+	va_end(va);
+}
+
 sstring_t gcc_rtti_t::vtname(const sstring_t &name) const
 {
 	return sstring_t("__ZTV") + name;
@@ -441,6 +1808,7 @@ auto gcc_rtti_t::get_class(const ea_t address) -> class_t *
 	if (!class_ptr)
 	{
 		class_ptr = std::make_unique<class_t>();
+		class_ptr->m_address = address;
 		class_ptr->m_id = m_current_class_id++;
 	}
 	return class_ptr.get();
@@ -451,6 +1819,48 @@ auto gcc_rtti_t::get_classes() const -> const classes_t &
 	return m_classes;
 }
 
+const hierarchy_t *gcc_rtti_t::get_hierarchy() const
+{
+	return m_hierarchy.get();
+}
+
+const overrides_t *gcc_rtti_t::get_overrides() const
+{
+	// slots are labeled on first use only, it walks every slot of every vtable
+	if (!m_overrides && m_hierarchy)
+	{
+		m_overrides = std::make_unique<overrides_t>();
+		m_overrides->build(*this, *m_hierarchy);
+	}
+	return m_overrides.get();
+}
+
+const options_t &gcc_rtti_t::get_options() const
+{
+	return m_options;
+}
+
+void gcc_rtti_t::get_vtable_slots(const class_t *const c, array_dyn_t<ea_t> &slots) const
+{
+	if (utils::is_bad_addr(c->m_vtable))
+	{
+		return;
+	}
+
+	// slots end at first pointer which does not point to code (offset to top of next vtable, etc.)
+	for (ea_t address = c->m_vtable + sizeof(ea_t); slots.size() < MAX_VTABLE_SLOTS; address += sizeof(ea_t))
+	{
+		const ea_t target = get_pointer(address);
+		const segment_t *const segment = getseg(target);
+		if (!segment || (segment->type != SEG_CODE && segment->type != SEG_XTRN))
+		{
+			break;
+		}
+
+		slots.push_back(target);
+	}
+}
+
 gcc_rtti_t *gcc_rtti_t::s_instance = nullptr;
 
 gcc_rtti_t *gcc_rtti_t::instance()
@@ -481,7 +1891,7 @@ bool idaapi gcc_rtti_t::run_s(size_t arg)
 {
 	if (s_instance)
 	{
-		s_instance->run();
+		s_instance->run(arg);
 	}
 	return true;
 }
@@ -13,9 +13,17 @@
 #pragma once
 
 #include <utils.hxx>
+#include <options.hxx>
 
 /* forward declarations */
 class graph_t;
+class hierarchy_t;
+class tracker_t;
+class fixups_t;
+class symbols_t;
+class snapshot_t;
+class overrides_t;
+class known_types_t;
 
 class gcc_rtti_t
 {
@@ -30,7 +38,7 @@ public:
 
 	bool init();
 	void destroy();
-	void run();
+	void run(const size_t arg);
 
 	static gcc_rtti_t *instance();
 
@@ -42,6 +50,25 @@ public:
 private:
 	static gcc_rtti_t *s_instance;
 
+public:
+	/* plugin argument bits */
+	enum run_flags_t : size_t
+	{
+		RUN_BATCH = 0x1, // no UI, everything is taken from options
+	};
+
+	/* exit codes of batch mode */
+	enum status_t
+	{
+		STATUS_OK = 0,
+		STATUS_BAD_OPTIONS,
+		STATUS_NO_STRINGS,
+		STATUS_NO_CLASSES,
+		STATUS_OUTPUT_FAILED,
+		STATUS_COUNT /* always at end */
+	};
+	static const string status_names[gcc_rtti_t::STATUS_COUNT];
+
 public:
 	class class_t;
 	using classes_t = map_t<ea_t, unique_ptr_t<class_t>>;
@@ -56,35 +83,129 @@ private:
 		TI_CTINFO,
 		TI_SICTINFO,
 		TI_VMICTINFO,
+		TI_POINTER,
+		TI_POINTER_TO_MEMBER,
+		TI_FUNCTION,
+		TI_ENUM,
+		TI_FUNDAMENTAL,
+		TI_ARRAY,
 		TI_COUNT /* always at end */
 	};
-	static const string ti_names[gcc_rtti_t::TI_COUNT];
+
+	/* description of type info kind, kinds are handled in order of table */
+	class ti_kind_t
+	{
+	public:
+		string	m_name;			// mangled name of __cxxabiv1 class, its vtable is vtname(m_name)
+		string	m_description;
+		string	m_layout;		// format_struct() layout of fields following the ones handled by formatter
+		ea_t	(gcc_rtti_t::*m_formatter)(const ea_t address);
+		bool	m_class;		// describes class, so class_t is made for it
+	};
+	static const ti_kind_t ti_kinds[gcc_rtti_t::TI_COUNT];
+
+	/* longest type info record: vmi with 100 bases */
+	static const ea_t MAX_TYPE_INFO_SIZE = sizeof(ea_t) * 2 + sizeof(uint32) * 2 + 100 * sizeof(ea_t) * 2;
+
+	/* limit of vtable slots, in case of broken data */
+	static const size_t MAX_VTABLE_SLOTS = 0x10000;
+
+	status_t analyze();
+	void write_summary(const status_t status) const;
 
 	void initialize_segments_data();
+	bool load_segment_data(segment_t *const segment);
 
 	ea_t find_string(const string s) const;
 	void find_type_info(const ti_types_t idx);
-	void handle_classes(ti_types_t idx, ea_t(gcc_rtti_t::*const formatter)(const ea_t address));
+	void handle_type_infos();
+	bool is_type_info_candidate(const segment_data_t &segment_data, const size_t current) const;
+	ti_types_t get_type_info_type(const ea_t vtable) const;
+	ea_t parse_type_info(const ti_types_t type, const ea_t address); // returns end of record
 
+	ea_t format_type_header(const ea_t address, sstring_t &mangled_name);
+	ea_t format_plain_type_info(const ea_t address);
 	ea_t format_type_info(const ea_t address);
 	ea_t format_si_type_info(const ea_t address);
 	ea_t format_vmi_type_info(const ea_t address);
 
+	ea_t find_vtable_fixups(const ea_t address) const;
+	ea_t find_vtable_symbol(const sstring_t &mangled_name, const ea_t address) const;
+	bool is_vtable_of(const ea_t vtable, const ea_t address) const;
+	void format_vtable(class_t *const c, const ea_t vtable);
+
+	void handle_vtables();
+	bool get_vtable_symbol_class(const ea_t symbol, sstring_t &class_name) const;
+	bool diff_snapshot();
+	void apply_overrides();
+	void handle_structors();
+	void handle_layouts();
+
+	bool has_known_bases(const ea_t address) const;
+	void resolve_known_bases();
+	void resolve_pending_vtables();
+
 	ea_t format_struct(ea_t address, const string fmt);
+	bool apply_name(const ea_t address, const sstring_t &name);
 
 	sstring_t vtname(const sstring_t &name) const;
 
+	void log(const char *const format, ...) const;
+	void report(const char *const format, ...) const; // warning dialog, or log in batch mode
+
 	class_t *get_class(const ea_t address);
 
 public:
 	const classes_t &get_classes() const;
+	const hierarchy_t *get_hierarchy() const;
+	const overrides_t *get_overrides() const; // labels of vtable slots, built on first call
+	const options_t &get_options() const;
+
+	/* pointer stored at address, target of relocation is preferred */
+	ea_t get_pointer(const ea_t address) const;
+
+	/* virtual methods in vtable of class, in order of slots */
+	void get_vtable_slots(const class_t *const c, array_dyn_t<ea_t> &slots) const;
+
+	/* names of methods and comments of vtable slots made by plugin itself (overrides and structors options) */
+	static bool is_generated_name(const char *const name);
+	static bool is_generated_comment(const char *const comment);
+
+	/* parses again type infos and vtables in changed ranges, called by tracker_t;
+	   ranges formatted by plugin itself are added to touched */
+	void update(const rangeset_t &dirty, const rangeset_t &dirty_segments, rangeset_t &touched);
+
+	/* exports graph again if classes have changed since last export, called by tracker_t when changes stop */
+	void refresh_outputs();
+
+private:
+	void reload_segments_data(const range_t &range);
+	void collect_changes(const range_t &range, map_t<ea_t, ti_types_t> &type_infos, map_t<ea_t, bool> &affected, map_t<ea_t, ea_t> &vtables);
+	void remove_classes(const array_dyn_t<ea_t> &addresses, classes_t &removed);
+	const segment_data_t *find_segment_data(const ea_t address) const;
 
 private:
 	utils::strings_data_t	m_strings;
 	segments_data_t			m_segments_data;
 	classes_t				m_classes;
 	unique_ptr_t<graph_t>	m_graph;
+	unique_ptr_t<hierarchy_t> m_hierarchy;
+	mutable unique_ptr_t<overrides_t> m_overrides;	// built by get_overrides() when needed
+	unique_ptr_t<tracker_t>	m_tracker;
+	unique_ptr_t<fixups_t>	m_fixups;	// set when references are discovered from relocations
+	unique_ptr_t<symbols_t>	m_symbols;	// set when database has type info related names
+	array_dyn_t<ea_t>		m_ti_vtables[TI_COUNT];	// address points of __cxxabiv1 vtables of every kind
+	options_t				m_options;
+	unique_ptr_t<known_types_t> m_known_types;
+	unique_ptr_t<snapshot_t> m_snapshot;	// previous build, loaded by diff option
+	array_dyn_t<std::pair<class_t *, uint32>> m_known_pending; // known classes waiting for bases from database
+	hash_map_t<uint64, class_t *> m_classes_by_name; // hash of mangled name -> class, kept up to date by update
+	array_dyn_t<class_t *>	m_pending_vtables;	// classes whose vtable was not found by symbol or fixup
+	array_dyn_t<sstring_t>	m_outputs;
 	unsigned int			m_current_class_id;
+	bool					m_console;	// stdout is available
+	bool					m_fixups_only;	// references are taken from relocations only, data is not scanned
+	bool					m_outputs_stale;	// classes changed by update since graph was exported
 };
 
 class gcc_rtti_t::class_t
@@ -92,6 +213,14 @@ class gcc_rtti_t::class_t
 public:
 	class base_t
 	{
+	public:
+		/* __base_class_type_info::__offset_flags_masks */
+		enum offset_flags_t : uint
+		{
+			FLAG_VIRTUAL	= 0x1,
+			FLAG_PUBLIC		= 0x2,
+		};
+
 	public:
 		base_t(class_t *const class_ptr)
 			: m_class(class_ptr)
@@ -107,6 +236,11 @@ public:
 		{
 		}
 
+		bool is_virtual() const
+		{
+			return (m_flags & FLAG_VIRTUAL) != 0;
+		}
+
 	public:
 		class_t *m_class;
 		uint	 m_offset;
@@ -121,9 +255,15 @@ public:
 
 public:
 	sstring_t			m_name;
+	sstring_t			m_mangled_name;		// as in typeinfo name, without '*' prefix
 	array_dyn_t<base_t> m_bases;
+	ea_t				m_address = BADADDR; // address of type info
+	ea_t				m_ti_end = BADADDR;	 // end of type info record
+	ea_t				m_vtable = BADADDR;	 // address of type info pointer in vtable (address point - ptrsize)
 	unsigned int		m_id;
 	bool				m_shown = false;
+	bool				m_known = false;	// found in known types database
+	bool				m_inferred = false;	// found by vtable only (no type info), bases are guessed from slots
 };
 
 class gcc_rtti_t::segment_data_t
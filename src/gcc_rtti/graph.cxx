@@ -14,40 +14,120 @@
 
 #include "graph.hxx"
 
-void graph_t::run()
+bool graph_t::run(const options_t &options, array_dyn_t<sstring_t> &outputs)
+{
+	if (options.m_batch)
+	{
+		return run_batch(options, outputs);
+	}
+	return run_interactive(options, outputs);
+}
+
+bool graph_t::run_interactive(const options_t &options, array_dyn_t<sstring_t> &outputs)
 {
 	const string question = "Do you want to generate graph?\n";
 	const int answer = ask_buttons("Yes", "No", "Cancel", ASKBTN_YES, question);
 
 	if (answer != ASKBTN_YES)
 	{
-		return;
+		return true;
 	}
 
-	if (!fill_ignored_prefixes())
+	if (!fill_ignored_prefixes(options))
 	{
-		return;
+		return true;
 	}
 
 	process_ignored_prefixes();
 
 	const string filepath = ask_file(true, "", "*.dot", "Choose file to which save the graph...");
 
-	if (!filepath)
+	if (!filepath || options.m_dry_run)
+	{
+		return true;
+	}
+
+	if (!save("dot", filepath))
+	{
+		return false;
+	}
+
+	outputs.push_back(filepath);
+	return true;
+}
+
+bool graph_t::run_batch(const options_t &options, array_dyn_t<sstring_t> &outputs)
+{
+	m_ignored_prefixes = options.m_ignored_prefixes;
+	process_ignored_prefixes();
+
+	if (options.m_output.empty() || options.m_dry_run)
+	{
+		return true;
+	}
+
+	bool result = true;
+	for (const sstring_t &format : options.m_formats)
+	{
+		const sstring_t filepath = options.m_output + "." + format;
+
+		const bool saved = save(format, filepath);
+		if (saved)
+		{
+			outputs.push_back(filepath);
+		}
+		result = result && saved;
+	}
+
+	return result;
+}
+
+void graph_t::refresh()
+{
+	if (m_exports.empty())
 	{
 		return;
 	}
 
-	save_to_file(filepath);
+	for (const auto &class_pair : gcc_rtti_t::instance()->get_classes())
+	{
+		if (class_pair.second)
+		{
+			class_pair.second->m_shown = false;
+		}
+	}
+
+	process_ignored_prefixes();
+
+	for (const auto &export_pair : m_exports)
+	{
+		if (export_pair.first == "dot")
+		{
+			save_to_file(export_pair.second.c_str());
+		}
+		else if (export_pair.first == "csv")
+		{
+			save_to_csv(export_pair.second.c_str());
+		}
+	}
 }
 
-bool graph_t::fill_ignored_prefixes()
+bool graph_t::fill_ignored_prefixes(const options_t &options)
 {
-	const string default_value = "std\ntype_info";
+	sstring_t default_value;
+	for (const sstring_t &prefix : options.m_ignored_prefixes)
+	{
+		if (!default_value.empty())
+		{
+			default_value += '\n';
+		}
+		default_value += prefix;
+	}
+
 	const string question = "List of ignored prefixes:";
 
 	qstring ignore_namespaces_buffer;
-	if (!ask_text(&ignore_namespaces_buffer, 2048, default_value, question))
+	if (!ask_text(&ignore_namespaces_buffer, 2048, default_value.c_str(), question))
 	{
 		return false;
 	}
@@ -103,6 +183,11 @@ void graph_t::process_ignored_prefixes()
 			}
 		}
 
+		if (class_pair.second->m_known && gcc_rtti_t::instance()->get_options().m_ignore_known)
+		{
+			is_ignored = true;
+		}
+
 		if (is_ignored && !class_pair.second->m_shown)
 		{
 			continue;
@@ -127,12 +212,32 @@ void graph_t::make_class_bases_visible(gcc_rtti_t::class_t *const c)
 	}
 }
 
+bool graph_t::save(const sstring_t &format, const sstring_t &filepath)
+{
+	bool saved = false;
+	if (format == "dot")
+	{
+		saved = save_to_file(filepath.c_str());
+	}
+	else if (format == "csv")
+	{
+		saved = save_to_csv(filepath.c_str());
+	}
+
+	// remembered, so graph can be refreshed when classes change
+	if (saved)
+	{
+		m_exports.push_back(std::make_pair(format, filepath));
+	}
+	return saved;
+}
+
 bool graph_t::save_to_file(const string filepath)
 {
 	FILE *const file = qfopen(filepath, "wb");
 	if (!file)
 	{
-		warning("Unable to open file for write!");
+		report_open_failure(filepath);
 		return false;
 	}
 
@@ -176,4 +281,70 @@ bool graph_t::save_to_file(const string filepath)
 	return true;
 }
 
+bool graph_t::save_to_csv(const string filepath)
+{
+	FILE *const file = qfopen(filepath, "wb");
+	if (!file)
+	{
+		report_open_failure(filepath);
+		return false;
+	}
+
+	// one row per class, bases are ids separated by spaces
+	qfprintf(file, "id,address,name,bases\n");
+
+	const auto &classes = gcc_rtti_t::instance()->get_classes();
+
+	for (const auto &class_pair : classes)
+	{
+		if (!class_pair.second || !class_pair.second->m_shown)
+		{
+			continue;
+		}
+
+		sstring_t bases;
+		for (const auto &base : class_pair.second->m_bases)
+		{
+			if (!base.m_class)
+			{
+				continue;
+			}
+
+			if (!bases.empty())
+			{
+				bases += ' ';
+			}
+			bases.cat_sprnt("%u", base.m_class->m_id);
+		}
+
+		sstring_t name;
+		for (const char *c = class_pair.second->m_name.c_str(); *c; ++c)
+		{
+			name += *c;
+			if (*c == '"')
+			{
+				name += '"';
+			}
+		}
+
+		qfprintf(file, "%u," ADDR_FORMAT ",\"%s\",%s\n", class_pair.second->m_id, class_pair.first, name.c_str(), bases.c_str());
+	}
+
+	qflush(file);
+	qfclose(file);
+	return true;
+}
+
+void graph_t::report_open_failure(const string filepath)
+{
+	if (gcc_rtti_t::instance()->get_options().m_batch)
+	{
+		msg("Unable to open file %s for write!\n", filepath);
+	}
+	else
+	{
+		warning("Unable to open file for write!");
+	}
+}
+
 /* eof */
@@ -17,16 +17,26 @@
 class graph_t
 {
 public:
-	void run();
+	bool run(const options_t &options, array_dyn_t<sstring_t> &outputs);
+
+	/* exports graph again to the same files, after classes have been changed */
+	void refresh();
 
 private:
-	bool fill_ignored_prefixes();
+	bool run_interactive(const options_t &options, array_dyn_t<sstring_t> &outputs);
+	bool run_batch(const options_t &options, array_dyn_t<sstring_t> &outputs);
+
+	bool fill_ignored_prefixes(const options_t &options);
 	void process_ignored_prefixes();
 	void make_class_bases_visible(gcc_rtti_t::class_t *const c);
+	bool save(const sstring_t &format, const sstring_t &filepath);
 	bool save_to_file(const string filepath);
+	bool save_to_csv(const string filepath);
+	void report_open_failure(const string filepath);
 
 private:
 	array_dyn_t<sstring_t> m_ignored_prefixes;
+	array_dyn_t<std::pair<sstring_t, sstring_t>> m_exports; // format, path
 };
 
 /* eof */
@@ -0,0 +1,627 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#include <stdinc.hxx>
+
+#include "hierarchy.hxx"
+
+const unsigned int hierarchy_t::NO_INDEX;
+
+void hierarchy_t::build(const gcc_rtti_t::classes_t &classes)
+{
+	clear();
+
+	unsigned int id_count = 0;
+	for (const auto &class_pair : classes)
+	{
+		if (class_pair.second)
+		{
+			id_count = std::max(id_count, class_pair.second->m_id + 1);
+		}
+	}
+
+	m_order.reserve(classes.size());
+	m_order_of.resize(id_count, NO_INDEX);
+
+	array_dyn_t<uchar> state;
+	state.resize(id_count, 0);
+
+	for (const auto &class_pair : classes)
+	{
+		if (class_pair.second)
+		{
+			sort_topologically(class_pair.second.get(), state);
+		}
+	}
+
+	const unsigned int count = static_cast<unsigned int>(m_order.size());
+
+	m_offsets.resize(count);
+	m_bases.resize(count);
+	m_derived.resize(count);
+
+	// offset-to-base tables (sorted ancestor lists), bases are always complete before derived class is processed
+	for (unsigned int order = 0; order < count; ++order)
+	{
+		m_order_of_address[m_order[order]->m_address] = order;
+		link_bases(order);
+		build_tables(order);
+	}
+
+	m_visited.resize(count, 0);
+	m_visit_stamp = 0;
+}
+
+bool hierarchy_t::update(const array_dyn_t<class_t *> &changed, const array_dyn_t<class_t *> &removed)
+{
+	// removed classes leave holes, so other ones keep their indices; their derived classes are built again
+	array_dyn_t<unsigned int> dirty;
+	for (const class_t *const c : removed)
+	{
+		const unsigned int order = get_order(c);
+		if (order == NO_INDEX)
+		{
+			continue;
+		}
+
+		for (const unsigned int base_order : m_bases[order])
+		{
+			array_dyn_t<unsigned int> &derived = m_derived[base_order];
+			derived.erase(std::remove(derived.begin(), derived.end(), order), derived.end());
+		}
+
+		for (const unsigned int derived : m_derived[order])
+		{
+			dirty.push_back(derived);
+		}
+
+		m_bases[order].clear();
+		m_derived[order].clear();
+		m_offsets[order].clear();
+
+		const auto found = m_order_of_address.find(c->m_address);
+		if (found != m_order_of_address.end() && found->second == order)
+		{
+			m_order_of_address.erase(found);
+		}
+
+		m_order_of[c->m_id] = NO_INDEX;
+		m_order[order] = nullptr;
+		++m_holes_count;
+	}
+
+	// too many holes make traversals of topological order slow, build() closes them
+	if (m_holes_count > m_order.size() / 2)
+	{
+		return false;
+	}
+
+	unsigned int id_count = static_cast<unsigned int>(m_order_of.size());
+	for (const class_t *const c : changed)
+	{
+		id_count = std::max(id_count, c->m_id + 1);
+	}
+
+	// new classes (and their new bases) are appended, classes already present keep their index
+	const unsigned int old_count = static_cast<unsigned int>(m_order.size());
+	m_order_of.resize(id_count, NO_INDEX);
+
+	array_dyn_t<uchar> state;
+	state.resize(id_count, 0);
+	for (unsigned int order = 0; order < old_count; ++order)
+	{
+		if (m_order[order])
+		{
+			state[m_order[order]->m_id] = 2;
+		}
+	}
+
+	for (class_t *const c : changed)
+	{
+		sort_topologically(c, state);
+
+		// new bases of class already present are placed after it, this is caught below
+		for (const class_t::base_t &base : c->m_bases)
+		{
+			if (base.m_class)
+			{
+				sort_topologically(base.m_class, state);
+			}
+		}
+	}
+
+	const unsigned int count = static_cast<unsigned int>(m_order.size());
+
+	// base which is placed after class would break topological order
+	for (const class_t *const c : changed)
+	{
+		const unsigned int order = m_order_of[c->m_id];
+		for (const class_t::base_t &base : c->m_bases)
+		{
+			if (base.m_class && get_order(base.m_class) > order)
+			{
+				return false;
+			}
+		}
+	}
+
+	m_offsets.resize(count);
+	m_bases.resize(count);
+	m_derived.resize(count);
+	m_visited.resize(count, 0);
+
+	// derived classes of removed ones may have been removed as well
+	dirty.erase(std::remove_if(dirty.begin(), dirty.end(), [this](const unsigned int order)
+	{
+		return m_order[order] == nullptr;
+	}), dirty.end());
+
+	for (unsigned int order = old_count; order < count; ++order)
+	{
+		m_order_of_address[m_order[order]->m_address] = order;
+		dirty.push_back(order);
+	}
+
+	for (const class_t *const c : changed)
+	{
+		const unsigned int order = m_order_of[c->m_id];
+		if (order < old_count)
+		{
+			dirty.push_back(order);
+		}
+	}
+
+	for (const unsigned int order : dirty)
+	{
+		link_bases(order);
+	}
+
+	// ancestors of descendants of changed classes have changed too
+	if (++m_visit_stamp == 0)
+	{
+		std::fill(m_visited.begin(), m_visited.end(), 0);
+		m_visit_stamp = 1;
+	}
+
+	for (size_t i = 0; i < dirty.size(); ++i)
+	{
+		m_visited[dirty[i]] = m_visit_stamp;
+	}
+
+	for (size_t i = 0; i < dirty.size(); ++i)
+	{
+		for (const unsigned int derived : m_derived[dirty[i]])
+		{
+			if (m_visited[derived] != m_visit_stamp)
+			{
+				m_visited[derived] = m_visit_stamp;
+				dirty.push_back(derived);
+			}
+		}
+	}
+
+	std::sort(dirty.begin(), dirty.end());
+	dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+	for (const unsigned int order : dirty)
+	{
+		build_tables(order);
+	}
+
+	return true;
+}
+
+void hierarchy_t::clear()
+{
+	m_order.clear();
+	m_order_of.clear();
+	m_order_of_address.clear();
+	m_offsets.clear();
+	m_bases.clear();
+	m_derived.clear();
+	m_visited.clear();
+	m_visit_stamp = 0;
+	m_holes_count = 0;
+}
+
+bool hierarchy_t::is_derived_from(const class_t *const derived, const class_t *const base) const
+{
+	const unsigned int derived_order = get_order(derived);
+	const unsigned int base_order = get_order(base);
+
+	if (derived_order == NO_INDEX || base_order == NO_INDEX)
+	{
+		return false;
+	}
+
+	return find_ancestor(derived_order, base_order) != nullptr;
+}
+
+auto hierarchy_t::get_base_offset(const class_t *const derived, const class_t *const base) const -> const base_offset_t *
+{
+	const unsigned int derived_order = get_order(derived);
+	const unsigned int base_order = get_order(base);
+
+	if (derived_order == NO_INDEX || base_order == NO_INDEX)
+	{
+		return nullptr;
+	}
+
+	return find_ancestor(derived_order, base_order);
+}
+
+void hierarchy_t::get_derived(const class_t *const c, array_dyn_t<class_t *> &result) const
+{
+	const unsigned int order = get_order(c);
+	if (order == NO_INDEX)
+	{
+		return;
+	}
+
+	for (const unsigned int derived : m_derived[order])
+	{
+		result.push_back(m_order[derived]);
+	}
+}
+
+void hierarchy_t::get_ancestors(const class_t *const c, array_dyn_t<class_t *> &result) const
+{
+	const unsigned int order = get_order(c);
+	if (order == NO_INDEX)
+	{
+		return;
+	}
+
+	for (const base_offset_t &entry : m_offsets[order])
+	{
+		result.push_back(m_order[entry.m_base]);
+	}
+}
+
+void hierarchy_t::get_descendants(const class_t *const c, array_dyn_t<class_t *> &result) const
+{
+	const unsigned int order = get_order(c);
+	if (order == NO_INDEX)
+	{
+		return;
+	}
+
+	// stamps allow to skip clearing of visited flags before every traversal
+	if (++m_visit_stamp == 0)
+	{
+		std::fill(m_visited.begin(), m_visited.end(), 0);
+		m_visit_stamp = 1;
+	}
+
+	array_dyn_t<unsigned int> stack;
+	stack.push_back(order);
+
+	while (!stack.empty())
+	{
+		const unsigned int current = stack.back();
+		stack.pop_back();
+
+		for (const unsigned int derived : m_derived[current])
+		{
+			if (m_visited[derived] == m_visit_stamp)
+			{
+				continue;
+			}
+
+			m_visited[derived] = m_visit_stamp;
+			result.push_back(m_order[derived]);
+			stack.push_back(derived);
+		}
+	}
+}
+
+auto hierarchy_t::get_topological_order() const -> const array_dyn_t<class_t *> &
+{
+	return m_order;
+}
+
+unsigned int hierarchy_t::get_order(const class_t *const c) const
+{
+	if (!c || c->m_id >= m_order_of.size())
+	{
+		return NO_INDEX;
+	}
+	return m_order_of[c->m_id];
+}
+
+auto hierarchy_t::find_class(const ea_t address) const -> class_t *
+{
+	const auto found = m_order_of_address.find(address);
+	if (found == m_order_of_address.end())
+	{
+		return nullptr;
+	}
+	return m_order[found->second];
+}
+
+void hierarchy_t::sort_topologically(class_t *const c, array_dyn_t<uchar> &state)
+{
+	// 0 - not visited, 1 - in progress (cycle in broken data), 2 - done
+	if (state[c->m_id] != 0)
+	{
+		return;
+	}
+
+	state[c->m_id] = 1;
+
+	for (const class_t::base_t &base : c->m_bases)
+	{
+		if (base.m_class)
+		{
+			sort_topologically(base.m_class, state);
+		}
+	}
+
+	state[c->m_id] = 2;
+
+	m_order_of[c->m_id] = static_cast<unsigned int>(m_order.size());
+	m_order.push_back(c);
+}
+
+void hierarchy_t::link_bases(const unsigned int order)
+{
+	// previous bases of class (when it is linked again) are not its bases anymore
+	for (const unsigned int base_order : m_bases[order])
+	{
+		array_dyn_t<unsigned int> &derived = m_derived[base_order];
+		derived.erase(std::remove(derived.begin(), derived.end(), order), derived.end());
+	}
+	m_bases[order].clear();
+
+	for (const class_t::base_t &base : m_order[order]->m_bases)
+	{
+		if (!base.m_class || m_order_of[base.m_class->m_id] >= order)
+		{
+			continue; // cycle in broken data
+		}
+
+		const unsigned int base_order = m_order_of[base.m_class->m_id];
+		if (std::find(m_bases[order].begin(), m_bases[order].end(), base_order) == m_bases[order].end())
+		{
+			m_bases[order].push_back(base_order);
+			m_derived[base_order].push_back(order);
+		}
+	}
+}
+
+void hierarchy_t::build_tables(const unsigned int order)
+{
+	const class_t *const c = m_order[order];
+
+	array_dyn_t<base_offset_t> &offsets = m_offsets[order];
+	offsets.clear();
+
+	for (const class_t::base_t &base : c->m_bases)
+	{
+		if (!base.m_class)
+		{
+			continue;
+		}
+
+		const unsigned int base_order = m_order_of[base.m_class->m_id];
+		if (base_order >= order)
+		{
+			continue; // cycle in broken data
+		}
+
+		// offset of virtual base is known only at runtime (it is stored in vtable)
+		const bool is_virtual = base.is_virtual();
+		const sval_t offset = is_virtual ? 0 : static_cast<sval_t>(static_cast<int>(base.m_offset));
+
+		offsets.push_back(base_offset_t(base_order, offset, is_virtual ? base_order : NO_INDEX));
+
+		for (base_offset_t entry : m_offsets[base_order])
+		{
+			if (entry.m_virtual_base == NO_INDEX)
+			{
+				if (is_virtual)
+				{
+					entry.m_virtual_base = base_order;
+				}
+				else
+				{
+					entry.m_offset += offset;
+				}
+			}
+			offsets.push_back(entry);
+		}
+	}
+
+	// sort by base, first occurrence of repeated base (non-virtual diamond) wins
+	std::stable_sort(offsets.begin(), offsets.end(),
+		[](const base_offset_t &lhs, const base_offset_t &rhs)
+		{
+			return lhs.m_base < rhs.m_base;
+		}
+	);
+
+	offsets.erase(std::unique(offsets.begin(), offsets.end(),
+		[](const base_offset_t &lhs, const base_offset_t &rhs)
+		{
+			return lhs.m_base == rhs.m_base;
+		}
+	), offsets.end());
+}
+
+auto hierarchy_t::find_ancestor(const unsigned int order, const unsigned int ancestor) const -> const base_offset_t *
+{
+	// only classes placed before this one may be ancestors
+	if (ancestor >= order)
+	{
+		return nullptr;
+	}
+
+	const array_dyn_t<base_offset_t> &offsets = m_offsets[order];
+
+	const auto found = std::lower_bound(offsets.begin(), offsets.end(), ancestor,
+		[](const base_offset_t &entry, const unsigned int value)
+		{
+			return entry.m_base < value;
+		}
+	);
+
+	return (found != offsets.end() && found->m_base == ancestor) ? &*found : nullptr;
+}
+
+/* IDC interface, callable also from IDAPython through idc.eval_idc() */
+
+static const hierarchy_t *get_current_hierarchy()
+{
+	const gcc_rtti_t *const rtti = gcc_rtti_t::instance();
+	return rtti ? rtti->get_hierarchy() : nullptr;
+}
+
+static sstring_t format_classes(const array_dyn_t<gcc_rtti_t::class_t *> &classes)
+{
+	sstring_t result;
+	for (const gcc_rtti_t::class_t *const c : classes)
+	{
+		if (!result.empty())
+		{
+			result += ' ';
+		}
+		result.cat_sprnt(ADDR_FORMAT, c->m_address);
+	}
+	return result;
+}
+
+static error_t idaapi idc_is_derived(idc_value_t *argv, idc_value_t *result)
+{
+	result->set_long(0);
+	if (const hierarchy_t *const hierarchy = get_current_hierarchy())
+	{
+		const bool derived = hierarchy->is_derived_from
+		(
+			hierarchy->find_class(static_cast<ea_t>(argv[0].num)),
+			hierarchy->find_class(static_cast<ea_t>(argv[1].num))
+		);
+		result->set_long(derived ? 1 : 0);
+	}
+	return eOk;
+}
+
+static error_t idaapi idc_base_offset(idc_value_t *argv, idc_value_t *result)
+{
+	result->set_long(-1);
+	if (const hierarchy_t *const hierarchy = get_current_hierarchy())
+	{
+		const hierarchy_t::base_offset_t *const offset = hierarchy->get_base_offset
+		(
+			hierarchy->find_class(static_cast<ea_t>(argv[0].num)),
+			hierarchy->find_class(static_cast<ea_t>(argv[1].num))
+		);
+		if (offset)
+		{
+			result->set_long(offset->m_offset);
+		}
+	}
+	return eOk;
+}
+
+static error_t idaapi idc_virtual_base(idc_value_t *argv, idc_value_t *result)
+{
+	result->set_long(BADADDR);
+	if (const hierarchy_t *const hierarchy = get_current_hierarchy())
+	{
+		const hierarchy_t::base_offset_t *const offset = hierarchy->get_base_offset
+		(
+			hierarchy->find_class(static_cast<ea_t>(argv[0].num)),
+			hierarchy->find_class(static_cast<ea_t>(argv[1].num))
+		);
+		if (offset && offset->m_virtual_base != hierarchy_t::NO_INDEX)
+		{
+			result->set_long(hierarchy->get_topological_order()[offset->m_virtual_base]->m_address);
+		}
+	}
+	return eOk;
+}
+
+static error_t idaapi idc_ancestors(idc_value_t *argv, idc_value_t *result)
+{
+	array_dyn_t<gcc_rtti_t::class_t *> classes;
+	if (const hierarchy_t *const hierarchy = get_current_hierarchy())
+	{
+		hierarchy->get_ancestors(hierarchy->find_class(static_cast<ea_t>(argv[0].num)), classes);
+	}
+	result->set_string(format_classes(classes));
+	return eOk;
+}
+
+static error_t idaapi idc_descendants(idc_value_t *argv, idc_value_t *result)
+{
+	array_dyn_t<gcc_rtti_t::class_t *> classes;
+	if (const hierarchy_t *const hierarchy = get_current_hierarchy())
+	{
+		hierarchy->get_descendants(hierarchy->find_class(static_cast<ea_t>(argv[0].num)), classes);
+	}
+	result->set_string(format_classes(classes));
+	return eOk;
+}
+
+static error_t idaapi idc_class_count(idc_value_t *argv, idc_value_t *result)
+{
+	const hierarchy_t *const hierarchy = get_current_hierarchy();
+	result->set_long(hierarchy ? static_cast<sval_t>(hierarchy->get_topological_order().size()) : 0);
+	return eOk;
+}
+
+static error_t idaapi idc_class_at(idc_value_t *argv, idc_value_t *result)
+{
+	result->set_long(BADADDR);
+	if (const hierarchy_t *const hierarchy = get_current_hierarchy())
+	{
+		const sval_t order = argv[0].num;
+		if (order >= 0 && static_cast<size_t>(order) < hierarchy->get_topological_order().size()
+		 && hierarchy->get_topological_order()[static_cast<size_t>(order)])
+		{
+			result->set_long(hierarchy->get_topological_order()[static_cast<size_t>(order)]->m_address);
+		}
+	}
+	return eOk;
+}
+
+static const char idc_args_none[] = { 0 };
+static const char idc_args_ea[] = { VT_LONG, 0 };
+static const char idc_args_ea_ea[] = { VT_LONG, VT_LONG, 0 };
+
+static const ext_idcfunc_t idc_functions[] =
+{
+	{ "gcc_rtti_is_derived",	idc_is_derived,		idc_args_ea_ea,	nullptr, 0, 0 },	// (derived_ti, base_ti) -> 0/1
+	{ "gcc_rtti_base_offset",	idc_base_offset,	idc_args_ea_ea,	nullptr, 0, 0 },	// (derived_ti, base_ti) -> offset or -1
+	{ "gcc_rtti_virtual_base",	idc_virtual_base,	idc_args_ea_ea,	nullptr, 0, 0 },	// (derived_ti, base_ti) -> virtual base ti which offset is relative to, or BADADDR
+	{ "gcc_rtti_ancestors",		idc_ancestors,		idc_args_ea,	nullptr, 0, 0 },	// (ti) -> space separated ti addresses
+	{ "gcc_rtti_descendants",	idc_descendants,	idc_args_ea,	nullptr, 0, 0 },	// (ti) -> space separated ti addresses
+	{ "gcc_rtti_class_count",	idc_class_count,	idc_args_none,	nullptr, 0, 0 },	// () -> number of classes
+	{ "gcc_rtti_class_at",		idc_class_at,		idc_args_ea,	nullptr, 0, 0 },	// (topological index) -> ti or BADADDR (also for removed class)
+};
+
+void hierarchy_t::register_idc_functions()
+{
+	for (const ext_idcfunc_t &function : idc_functions)
+	{
+		add_idc_func(function);
+	}
+}
+
+void hierarchy_t::unregister_idc_functions()
+{
+	for (const ext_idcfunc_t &function : idc_functions)
+	{
+		del_idc_func(function.name);
+	}
+}
+
+/* eof */
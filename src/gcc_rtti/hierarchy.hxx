@@ -0,0 +1,93 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#pragma once
+
+#include "gcc_rtti.hxx"
+
+/**
+ * Query layer over parsed classes, built once after parsing and updated for changed classes only.
+ * Classes are indexed by their position in topological order (bases always come before derived classes),
+ * so ancestors of every class are built from already complete lists of its bases. Ancestors are kept as sorted
+ * sparse lists (together with offsets), memory is proportional to the number of ancestor relations and
+ * derivation check is a binary search in the list of derived class.
+ */
+class hierarchy_t
+{
+public:
+	using class_t = gcc_rtti_t::class_t;
+
+	static const unsigned int NO_INDEX = static_cast<unsigned int>(-1);
+
+	class base_offset_t
+	{
+	public:
+		base_offset_t(unsigned int base, sval_t offset, unsigned int virtual_base)
+			: m_base(base)
+			, m_offset(offset)
+			, m_virtual_base(virtual_base)
+		{
+		}
+
+	public:
+		unsigned int m_base;			// topological index of base class
+		sval_t		 m_offset;			// offset of base subobject (relative to m_virtual_base subobject, if any)
+		unsigned int m_virtual_base;	// topological index of the last virtual base on the path, or NO_INDEX
+	};
+
+public:
+	void build(const gcc_rtti_t::classes_t &classes);
+	void clear();
+
+	/* takes new classes and classes whose bases have changed, tables of their descendants are built again;
+	   removed classes (still alive during call) leave null holes in topological order;
+	   returns false when change breaks topological order (i.e. base placed after class), then build() is needed */
+	bool update(const array_dyn_t<class_t *> &changed, const array_dyn_t<class_t *> &removed);
+
+	bool is_derived_from(const class_t *const derived, const class_t *const base) const;
+	const base_offset_t *get_base_offset(const class_t *const derived, const class_t *const base) const;
+
+	void get_derived(const class_t *const c, array_dyn_t<class_t *> &result) const;
+	void get_ancestors(const class_t *const c, array_dyn_t<class_t *> &result) const;
+	void get_descendants(const class_t *const c, array_dyn_t<class_t *> &result) const;
+
+	/* classes in topological order, null for classes removed by update() since last build() */
+	const array_dyn_t<class_t *> &get_topological_order() const;
+	unsigned int get_order(const class_t *const c) const;
+	class_t *find_class(const ea_t address) const;
+
+	static void register_idc_functions();
+	static void unregister_idc_functions();
+
+private:
+	void sort_topologically(class_t *const c, array_dyn_t<uchar> &state);
+	void link_bases(const unsigned int order);
+	void build_tables(const unsigned int order);
+
+	const base_offset_t *find_ancestor(const unsigned int order, const unsigned int ancestor) const;
+
+private:
+	array_dyn_t<class_t *>		m_order;			// classes in topological order
+	array_dyn_t<unsigned int>	m_order_of;			// class id -> topological index
+	map_t<ea_t, unsigned int>	m_order_of_address;	// type info address -> topological index
+
+	// per class, so tables of changed classes are built again without moving the other ones
+	array_dyn_t<array_dyn_t<base_offset_t>> m_offsets;	// offset-to-base tables (all ancestors), each one sorted by m_base
+	array_dyn_t<array_dyn_t<unsigned int>> m_bases;		// direct bases, as linked into m_derived
+	array_dyn_t<array_dyn_t<unsigned int>> m_derived;		// direct derived classes
+
+	mutable array_dyn_t<unsigned int> m_visited;	// visit stamps used by traversals
+	mutable unsigned int		m_visit_stamp = 0;
+	unsigned int				m_holes_count = 0;	// removed classes in m_order
+};
+
+/* eof */
@@ -0,0 +1,279 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#include <stdinc.hxx>
+
+#include "known_types.hxx"
+
+static const char KNOWN_TYPES_MAGIC[4] = { 'G', 'R', 'K', 'T' };
+static const uint32 KNOWN_TYPES_VERSION = 1;
+
+const uint32 known_types_t::NO_STRING;
+const uint32 known_types_t::NO_ENTRY;
+
+bool known_types_t::load(const char *const filepath)
+{
+	m_data.clear();
+	m_entries = nullptr;
+	m_bases = nullptr;
+	m_strings = nullptr;
+	m_slot_count = 0;
+
+	if (!utils::read_file(filepath, "known types database", sizeof(header_t), m_data))
+	{
+		return false;
+	}
+
+	const header_t *const header = reinterpret_cast<const header_t *>(&m_data[0]);
+
+	const uint64 expected_size = sizeof(header_t)
+		+ static_cast<uint64>(header->m_slot_count) * sizeof(entry_t)
+		+ static_cast<uint64>(header->m_base_count) * sizeof(base_t)
+		+ header->m_strings_size;
+
+	if (!utils::check_file(m_data, filepath, "known types database", KNOWN_TYPES_MAGIC, KNOWN_TYPES_VERSION, expected_size, header->m_strings_size))
+	{
+		m_data.clear();
+		return false;
+	}
+
+	if (header->m_slot_count == 0 || (header->m_slot_count & (header->m_slot_count - 1)) != 0)
+	{
+		msg("Known types database %s is corrupted (size of hash table is not power of two)\n", filepath);
+		m_data.clear();
+		return false;
+	}
+
+	const uchar *current = &m_data[0] + sizeof(header_t);
+	const entry_t *const entries = reinterpret_cast<const entry_t *>(current);
+	current += header->m_slot_count * sizeof(entry_t);
+	const base_t *const bases = reinterpret_cast<const base_t *>(current);
+	current += header->m_base_count * sizeof(base_t);
+	const char *const strings = reinterpret_cast<const char *>(current);
+
+	// validate references once, so lookups do not have to
+	bool has_empty_slot = false;
+	for (uint32 slot = 0; slot < header->m_slot_count; ++slot)
+	{
+		const entry_t &entry = entries[slot];
+		if (entry.m_name == NO_STRING)
+		{
+			has_empty_slot = true;
+			continue;
+		}
+
+		bool valid = entry.m_name < header->m_strings_size
+			&& entry.m_demangled < header->m_strings_size
+			&& entry.m_first_base <= header->m_base_count
+			&& entry.m_base_count <= header->m_base_count - entry.m_first_base;
+
+		for (uint32 i = 0; valid && i < entry.m_base_count; ++i)
+		{
+			const uint32 base_slot = bases[entry.m_first_base + i].m_entry;
+			valid = base_slot < header->m_slot_count && entries[base_slot].m_name != NO_STRING;
+		}
+
+		if (!valid)
+		{
+			msg("Known types database %s is corrupted (slot %u)\n", filepath, slot);
+			m_data.clear();
+			return false;
+		}
+	}
+
+	if (!has_empty_slot)
+	{
+		msg("Known types database %s is corrupted (hash table is full)\n", filepath);
+		m_data.clear();
+		return false;
+	}
+
+	m_entries = entries;
+	m_bases = bases;
+	m_strings = strings;
+	m_slot_count = header->m_slot_count;
+	return true;
+}
+
+bool known_types_t::save(const gcc_rtti_t::classes_t &classes, const char *const filepath)
+{
+	using class_t = gcc_rtti_t::class_t;
+
+	size_t count = 0;
+	for (const auto &class_pair : classes)
+	{
+		if (class_pair.second && !class_pair.second->m_mangled_name.empty())
+		{
+			++count;
+		}
+	}
+
+	// keep load factor at most 1/2, so almost every lookup ends at the first probe
+	uint32 slot_count = 16;
+	while (slot_count < count * 2)
+	{
+		slot_count <<= 1;
+	}
+	const uint32 mask = slot_count - 1;
+
+	entry_t empty_entry;
+	empty_entry.m_hash = 0;
+	empty_entry.m_name = NO_STRING;
+	empty_entry.m_demangled = NO_STRING;
+	empty_entry.m_first_base = 0;
+	empty_entry.m_base_count = 0;
+
+	array_dyn_t<entry_t> entries;
+	entries.resize(slot_count, empty_entry);
+
+	array_dyn_t<const class_t *> slot_classes;
+	slot_classes.resize(slot_count, nullptr);
+
+	hash_map_t<const class_t *, uint32> class_slots;
+	utils::string_pool_t strings;
+
+	for (const auto &class_pair : classes)
+	{
+		const class_t *const c = class_pair.second.get();
+		if (!c || c->m_mangled_name.empty())
+		{
+			continue;
+		}
+
+		const uint64 hash = utils::hash_string(c->m_mangled_name.c_str());
+
+		uint32 slot = static_cast<uint32>(hash) & mask;
+		while (slot_classes[slot] && slot_classes[slot]->m_mangled_name != c->m_mangled_name)
+		{
+			slot = (slot + 1) & mask;
+		}
+
+		if (slot_classes[slot])
+		{
+			class_slots[c] = slot; // same type info emitted more than once
+			continue;
+		}
+
+		entries[slot].m_hash = hash;
+		entries[slot].m_name = strings.add(c->m_mangled_name.c_str());
+		entries[slot].m_demangled = strings.add(c->m_name.c_str());
+		slot_classes[slot] = c;
+		class_slots[c] = slot;
+	}
+
+	array_dyn_t<base_t> bases;
+	for (uint32 slot = 0; slot < slot_count; ++slot)
+	{
+		const class_t *const c = slot_classes[slot];
+		if (!c)
+		{
+			continue;
+		}
+
+		entries[slot].m_first_base = static_cast<uint32>(bases.size());
+
+		for (const class_t::base_t &base : c->m_bases)
+		{
+			const auto found = class_slots.find(base.m_class);
+			if (found == class_slots.end())
+			{
+				continue;
+			}
+
+			base_t entry_base;
+			entry_base.m_entry = found->second;
+			entry_base.m_offset = base.m_offset;
+			entry_base.m_flags = base.m_flags;
+			bases.push_back(entry_base);
+		}
+
+		entries[slot].m_base_count = static_cast<uint32>(bases.size()) - entries[slot].m_first_base;
+	}
+
+	if (strings.empty())
+	{
+		strings.add(""); // file always ends with zero
+	}
+
+	header_t header;
+	memcpy(header.m_magic, KNOWN_TYPES_MAGIC, sizeof(KNOWN_TYPES_MAGIC));
+	header.m_version = KNOWN_TYPES_VERSION;
+	header.m_slot_count = slot_count;
+	header.m_base_count = static_cast<uint32>(bases.size());
+	header.m_strings_size = strings.size();
+	header.m_reserved = 0;
+
+	FILE *const file = qfopen(filepath, "wb");
+	if (!file)
+	{
+		msg("Unable to open file %s for write!\n", filepath);
+		return false;
+	}
+
+	qfwrite(file, &header, sizeof(header));
+	qfwrite(file, &entries[0], entries.size() * sizeof(entry_t));
+	if (!bases.empty())
+	{
+		qfwrite(file, &bases[0], bases.size() * sizeof(base_t));
+	}
+	qfwrite(file, strings.data(), strings.size());
+	qfclose(file);
+	return true;
+}
+
+bool known_types_t::empty() const
+{
+	return m_slot_count == 0;
+}
+
+uint32 known_types_t::find(const char *const mangled_name) const
+{
+	if (m_slot_count == 0)
+	{
+		return NO_ENTRY;
+	}
+
+	const uint64 hash = utils::hash_string(mangled_name);
+	const uint32 mask = m_slot_count - 1;
+
+	// table is never full, so there is always an empty slot which terminates the probing
+	for (uint32 slot = static_cast<uint32>(hash) & mask;; slot = (slot + 1) & mask)
+	{
+		const entry_t &entry = m_entries[slot];
+		if (entry.m_name == NO_STRING)
+		{
+			return NO_ENTRY;
+		}
+
+		if (entry.m_hash == hash && strcmp(m_strings + entry.m_name, mangled_name) == 0)
+		{
+			return slot;
+		}
+	}
+}
+
+auto known_types_t::get_entry(const uint32 index) const -> const entry_t &
+{
+	return m_entries[index];
+}
+
+auto known_types_t::get_base(const uint32 index) const -> const base_t &
+{
+	return m_bases[index];
+}
+
+const char *known_types_t::get_string(const uint32 offset) const
+{
+	return m_strings + offset;
+}
+
+/* eof */
@@ -0,0 +1,83 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#pragma once
+
+#include "gcc_rtti.hxx"
+
+/**
+ * Prebuilt database of known library classes (libstdc++, boost, Qt, ...), keyed by mangled type name.
+ * It is produced from a database in which library was analyzed (known_types_save option) and loaded
+ * into memory as is, entries themselves form open addressing hash table, so lookup is a single probe
+ * in common case.
+ *
+ * File layout:
+ *   header_t
+ *   entry_t[header_t::m_slot_count]	- hash table, empty slots have m_name == NO_STRING
+ *   base_t[header_t::m_base_count]
+ *   char[header_t::m_strings_size]		- zero terminated strings
+ */
+class known_types_t
+{
+public:
+	static const uint32 NO_STRING = static_cast<uint32>(-1);
+	static const uint32 NO_ENTRY = static_cast<uint32>(-1);
+
+	class header_t
+	{
+	public:
+		char	m_magic[4];
+		uint32	m_version;
+		uint32	m_slot_count;	// power of two
+		uint32	m_base_count;
+		uint32	m_strings_size;
+		uint32	m_reserved;
+	};
+
+	class entry_t
+	{
+	public:
+		uint64	m_hash;			// utils::hash_string() of mangled name
+		uint32	m_name;			// mangled name (as in typeinfo name, without _ZTS)
+		uint32	m_demangled;	// demangled name
+		uint32	m_first_base;
+		uint32	m_base_count;
+	};
+
+	class base_t
+	{
+	public:
+		uint32	m_entry;		// slot of base class
+		uint32	m_offset;
+		uint32	m_flags;
+	};
+
+public:
+	bool load(const char *const filepath);
+	static bool save(const gcc_rtti_t::classes_t &classes, const char *const filepath);
+
+	bool empty() const;
+
+	uint32 find(const char *const mangled_name) const;
+	const entry_t &get_entry(const uint32 index) const;
+	const base_t &get_base(const uint32 index) const;
+	const char *get_string(const uint32 offset) const;
+
+private:
+	array_dyn_t<uchar>	m_data;
+	const entry_t		*m_entries = nullptr;
+	const base_t		*m_bases = nullptr;
+	const char			*m_strings = nullptr;
+	uint32				m_slot_count = 0;
+};
+
+/* eof */
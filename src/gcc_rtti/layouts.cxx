@@ -0,0 +1,212 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#include <stdinc.hxx>
+
+#include "layouts.hxx"
+#include "hierarchy.hxx"
+
+void layouts_t::build(const gcc_rtti_t &rtti, const hierarchy_t &hierarchy)
+{
+	clear();
+
+	const unsigned int count = static_cast<unsigned int>(hierarchy.get_topological_order().size());
+
+	// bases come before derived classes, so their layouts are always ready
+	m_non_virtual_begin.reserve(count + 1);
+	for (unsigned int order = 0; order < count; ++order)
+	{
+		build_non_virtual(hierarchy, order);
+	}
+	m_non_virtual_begin.push_back(m_non_virtual.size());
+
+	m_placed.resize(count, 0);
+	m_subobjects_begin.reserve(count + 1);
+	for (unsigned int order = 0; order < count; ++order)
+	{
+		build_complete(rtti, hierarchy, order);
+	}
+	m_subobjects_begin.push_back(m_subobjects.size());
+}
+
+void layouts_t::clear()
+{
+	m_non_virtual.clear();
+	m_non_virtual_begin.clear();
+	m_subobjects.clear();
+	m_subobjects_begin.clear();
+	m_placed.clear();
+}
+
+const layouts_t::subobject_t *layouts_t::get_layout(const unsigned int order, size_t &count) const
+{
+	if (order + 1 >= m_subobjects_begin.size())
+	{
+		count = 0;
+		return nullptr;
+	}
+
+	count = m_subobjects_begin[order + 1] - m_subobjects_begin[order];
+	return &m_subobjects[m_subobjects_begin[order]];
+}
+
+void layouts_t::build_non_virtual(const hierarchy_t &hierarchy, const unsigned int order)
+{
+	const class_t *const c = hierarchy.get_topological_order()[order];
+
+	const size_t self = m_non_virtual.size();
+	m_non_virtual_begin.push_back(self);
+	if (!c)
+	{
+		return; // removed by update
+	}
+
+	m_non_virtual.push_back(subobject_t{ order, 0, false, !utils::is_bad_addr(c->m_vtable) });
+
+	for (const class_t::base_t &base : c->m_bases)
+	{
+		if (!base.m_class || base.is_virtual())
+		{
+			continue;
+		}
+
+		const unsigned int base_order = hierarchy.get_order(base.m_class);
+		if (base_order == hierarchy_t::NO_INDEX || base_order >= order)
+		{
+			continue; // cycle in broken data
+		}
+
+		const sval_t offset = static_cast<sval_t>(static_cast<int>(base.m_offset));
+		for (size_t i = m_non_virtual_begin[base_order]; i < m_non_virtual_begin[base_order + 1]; ++i)
+		{
+			subobject_t entry = m_non_virtual[i];
+			entry.m_offset += offset;
+
+			// primary base shares vptr with class, it is named after the most derived one
+			if (entry.m_offset == 0 && m_non_virtual[self].m_vptr)
+			{
+				entry.m_vptr = false;
+			}
+			m_non_virtual.push_back(entry);
+		}
+	}
+}
+
+void layouts_t::build_complete(const gcc_rtti_t &rtti, const hierarchy_t &hierarchy, const unsigned int order)
+{
+	const array_dyn_t<class_t *> &classes = hierarchy.get_topological_order();
+	const class_t *const c = classes[order];
+
+	const size_t first = m_subobjects.size();
+	m_subobjects_begin.push_back(first);
+	if (!c)
+	{
+		return;
+	}
+
+	for (size_t i = m_non_virtual_begin[order]; i < m_non_virtual_begin[order + 1]; ++i)
+	{
+		m_subobjects.push_back(m_non_virtual[i]);
+	}
+
+	// address points of vtables in group of class, by offset of subobject which uses them
+	hash_map_t<sval_t, ea_t> address_points;
+	const unsigned int stamp = order + 1;
+
+	// subobjects of placed virtual bases are appended, so their own virtual bases are visited too
+	for (size_t i = first; i < m_subobjects.size(); ++i)
+	{
+		const subobject_t subobject = m_subobjects[i];
+
+		for (const class_t::base_t &base : classes[subobject.m_class]->m_bases)
+		{
+			if (!base.m_class || !base.is_virtual())
+			{
+				continue;
+			}
+
+			const unsigned int base_order = hierarchy.get_order(base.m_class);
+			if (base_order == hierarchy_t::NO_INDEX || base_order >= order || m_placed[base_order] == stamp)
+			{
+				continue;
+			}
+
+			auto found = address_points.find(subobject.m_offset);
+			if (found == address_points.end())
+			{
+				found = address_points.emplace(subobject.m_offset, find_address_point(rtti, c, subobject.m_offset)).first;
+			}
+
+			const ea_t address_point = found->second;
+			const sval_t slot = static_cast<sval_t>(static_cast<int>(base.m_offset));
+			if (utils::is_bad_addr(address_point) || slot >= 0)
+			{
+				continue; // no vtable for subobject, or offset is not a vbase offset slot
+			}
+
+			const sval_t offset = subobject.m_offset + static_cast<sval_t>(utils::get_ea(address_point + slot));
+			if (offset < 0 || offset > MAX_OBJECT_SIZE)
+			{
+				continue; // nearly empty virtual base may be primary, at offset 0
+			}
+
+			m_placed[base_order] = stamp;
+			for (size_t j = m_non_virtual_begin[base_order]; j < m_non_virtual_begin[base_order + 1]; ++j)
+			{
+				subobject_t entry = m_non_virtual[j];
+				entry.m_offset += offset;
+				entry.m_virtual = true;
+
+				// primary virtual base shares vptr with class as well
+				if (entry.m_offset == 0 && m_subobjects[first].m_vptr)
+				{
+					entry.m_vptr = false;
+				}
+				m_subobjects.push_back(entry);
+			}
+		}
+	}
+
+	// class itself stays first, subobjects at the same offset keep order from most derived one
+	std::stable_sort(m_subobjects.begin() + first, m_subobjects.end(), [](const subobject_t &lhs, const subobject_t &rhs)
+	{
+		return lhs.m_offset < rhs.m_offset;
+	});
+}
+
+ea_t layouts_t::find_address_point(const gcc_rtti_t &rtti, const class_t *const c, const sval_t offset) const
+{
+	if (utils::is_bad_addr(c->m_vtable))
+	{
+		return BADADDR;
+	}
+
+	if (offset == 0)
+	{
+		return c->m_vtable + sizeof(ea_t);
+	}
+
+	// secondary vtables follow the primary one, each starts with -offset as offset to top and the same type info
+	const ea_t offset_to_top = static_cast<ea_t>(-offset);
+	ea_t address = c->m_vtable + sizeof(ea_t);
+
+	for (int i = 0; i < MAX_GROUP_SIZE && is_loaded(address); ++i, address += sizeof(ea_t))
+	{
+		if (utils::get_ea(address) == offset_to_top && rtti.get_pointer(address + sizeof(ea_t)) == c->m_address)
+		{
+			return address + sizeof(ea_t) * 2;
+		}
+	}
+	return BADADDR;
+}
+
+/* eof */
@@ -0,0 +1,65 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#pragma once
+
+#include "gcc_rtti.hxx"
+
+class hierarchy_t;
+
+/**
+ * Object layouts of classes: offsets of all base subobjects and positions of vptrs.
+ * Non-virtual part of every class is built once, in topological order, from already built non-virtual parts
+ * of its bases. Complete object adds virtual bases, their offsets are read from vbase offset slots of vtable
+ * group of the class (offset in base_class_type_info of virtual base is the offset of that slot), every
+ * virtual base is placed once even if it is reached by more paths.
+ */
+class layouts_t
+{
+public:
+	using class_t = gcc_rtti_t::class_t;
+
+	class subobject_t
+	{
+	public:
+		unsigned int	m_class;	// topological index
+		sval_t			m_offset;	// offset in complete object
+		bool			m_virtual;	// virtual base or part of it
+		bool			m_vptr;		// vptr at m_offset belongs to this subobject (it is shared with primary bases)
+	};
+
+public:
+	void build(const gcc_rtti_t &rtti, const hierarchy_t &hierarchy);
+	void clear();
+
+	/* subobjects of complete object of class at topological index, class itself first, then ordered by offset */
+	const subobject_t *get_layout(const unsigned int order, size_t &count) const;
+
+private:
+	void build_non_virtual(const hierarchy_t &hierarchy, const unsigned int order);
+	void build_complete(const gcc_rtti_t &rtti, const hierarchy_t &hierarchy, const unsigned int order);
+	ea_t find_address_point(const gcc_rtti_t &rtti, const class_t *const c, const sval_t offset) const;
+
+private:
+	static const int MAX_GROUP_SIZE = 0x1000;		// pointers scanned for secondary vtable in vtable group
+	static const sval_t MAX_OBJECT_SIZE = 0x1000000;	// larger vbase offset is garbage
+
+	array_dyn_t<subobject_t>	m_non_virtual;			// non-virtual parts of all classes, one after another
+	array_dyn_t<size_t>			m_non_virtual_begin;	// topological index -> first entry (count + 1 items)
+
+	array_dyn_t<subobject_t>	m_subobjects;			// complete objects of all classes, one after another
+	array_dyn_t<size_t>			m_subobjects_begin;		// topological index -> first entry (count + 1 items)
+
+	array_dyn_t<unsigned int>	m_placed;				// topological index -> stamp of class which placed it as virtual base
+};
+
+/* eof */
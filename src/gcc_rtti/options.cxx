@@ -0,0 +1,319 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#include <stdinc.hxx>
+
+#include "utils.hxx"
+#include "options.hxx"
+
+options_t::options_t()
+	: m_batch(false)
+	, m_dry_run(false)
+	, m_exit(false)
+	, m_known_types_fill(false)
+	, m_ignore_known(true)
+	, m_track(true)
+	, m_port_names(true)
+	, m_structors(false)
+	, m_layouts(false)
+	, m_discovery(DISCOVERY_AUTO)
+	, m_symbols(SYMBOLS_ON)
+	, m_vtables(VTABLES_AUTO)
+	, m_overrides(OVERRIDES_OFF)
+	, m_config_depth(0)
+{
+	m_ignored_prefixes.push_back("std");
+	m_ignored_prefixes.push_back("type_info");
+	m_formats.push_back("dot");
+}
+
+bool options_t::parse(const char *const text)
+{
+	if (!text)
+	{
+		return true;
+	}
+
+	for (const sstring_t &option : utils::split_string(text, ';'))
+	{
+		sstring_t key, value;
+
+		const char *const separator = strchr(option.c_str(), '=');
+		if (separator)
+		{
+			key = utils::trim_string(sstring_t(option.c_str(), separator - option.c_str()));
+			value = utils::trim_string(separator + 1);
+		}
+		else
+		{
+			key = utils::trim_string(option);
+		}
+
+		if (!set(key, value))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool options_t::load_file(const char *const filepath)
+{
+	FILE *const file = qfopen(filepath, "rb");
+	if (!file)
+	{
+		msg("gcc_rtti: unable to open config file %s\n", filepath);
+		return false;
+	}
+
+	bool result = true;
+
+	char line[4096];
+	while (result && qfgets(line, sizeof(line), file))
+	{
+		if (char *const comment = strchr(line, '#'))
+		{
+			*comment = '\0';
+		}
+
+		const sstring_t option = utils::trim_string(line);
+		if (!option.empty())
+		{
+			result = parse(option.c_str());
+		}
+	}
+
+	qfclose(file);
+	return result;
+}
+
+bool options_t::has_format(const char *const format) const
+{
+	for (const sstring_t &current : m_formats)
+	{
+		if (current == format)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool options_t::parse_flag(const sstring_t &value, bool &flag)
+{
+	// key without value turns flag on
+	if (value.empty() || value == "1" || value == "on" || value == "true" || value == "yes")
+	{
+		flag = true;
+		return true;
+	}
+	if (value == "0" || value == "off" || value == "false" || value == "no")
+	{
+		flag = false;
+		return true;
+	}
+	return false;
+}
+
+bool options_t::set(const sstring_t &key, const sstring_t &value)
+{
+	bool flag = false;
+	const bool is_flag = parse_flag(value, flag);
+
+	const auto set_flag = [&key, &value, is_flag, flag](bool &option) -> bool
+	{
+		if (!is_flag)
+		{
+			msg("gcc_rtti: invalid value '%s' of option '%s', expected 0/1, on/off, true/false or yes/no\n", value.c_str(), key.c_str());
+			return false;
+		}
+		option = flag;
+		return true;
+	};
+
+	if (key == "batch")
+	{
+		return set_flag(m_batch);
+	}
+	else if (key == "dry_run")
+	{
+		return set_flag(m_dry_run);
+	}
+	else if (key == "exit")
+	{
+		return set_flag(m_exit);
+	}
+	else if (key == "config")
+	{
+		// config file may include another one, but not itself over and over
+		if (m_config_depth >= MAX_CONFIG_DEPTH)
+		{
+			msg("gcc_rtti: config files nested too deep '%s'\n", value.c_str());
+			return false;
+		}
+
+		++m_config_depth;
+		const bool result = load_file(value.c_str());
+		--m_config_depth;
+		return result;
+	}
+	else if (key == "ignore")
+	{
+		m_ignored_prefixes = utils::split_string(value.c_str(), ',');
+	}
+	else if (key == "formats")
+	{
+		m_formats = utils::split_string(value.c_str(), ',');
+		for (const sstring_t &format : m_formats)
+		{
+			if (format != "dot" && format != "csv")
+			{
+				msg("gcc_rtti: unknown output format '%s'\n", format.c_str());
+				return false;
+			}
+		}
+	}
+	else if (key == "output")
+	{
+		m_output = value;
+	}
+	else if (key == "summary")
+	{
+		m_summary = value;
+	}
+	else if (key == "known_types")
+	{
+		m_known_types = value;
+	}
+	else if (key == "known_types_save")
+	{
+		m_known_types_save = value;
+	}
+	else if (key == "known_types_fill")
+	{
+		return set_flag(m_known_types_fill);
+	}
+	else if (key == "ignore_known")
+	{
+		return set_flag(m_ignore_known);
+	}
+	else if (key == "track")
+	{
+		return set_flag(m_track);
+	}
+	else if (key == "snapshot_save")
+	{
+		m_snapshot_save = value;
+	}
+	else if (key == "diff")
+	{
+		m_diff = value;
+	}
+	else if (key == "diff_report")
+	{
+		m_diff_report = value;
+	}
+	else if (key == "port_names")
+	{
+		return set_flag(m_port_names);
+	}
+	else if (key == "structors")
+	{
+		return set_flag(m_structors);
+	}
+	else if (key == "layouts")
+	{
+		return set_flag(m_layouts);
+	}
+	else if (key == "discovery")
+	{
+		if (value == "auto")
+		{
+			m_discovery = DISCOVERY_AUTO;
+		}
+		else if (value == "scan")
+		{
+			m_discovery = DISCOVERY_SCAN;
+		}
+		else if (value == "fixups")
+		{
+			m_discovery = DISCOVERY_FIXUPS;
+		}
+		else
+		{
+			msg("gcc_rtti: unknown discovery mode '%s'\n", value.c_str());
+			return false;
+		}
+	}
+	else if (key == "symbols")
+	{
+		if (is_flag)
+		{
+			m_symbols = flag ? SYMBOLS_ON : SYMBOLS_OFF;
+		}
+		else if (value == "only")
+		{
+			m_symbols = SYMBOLS_ONLY;
+		}
+		else
+		{
+			msg("gcc_rtti: unknown symbols mode '%s'\n", value.c_str());
+			return false;
+		}
+	}
+	else if (key == "vtables")
+	{
+		if (value == "auto")
+		{
+			m_vtables = VTABLES_AUTO;
+		}
+		else if (is_flag)
+		{
+			m_vtables = flag ? VTABLES_ON : VTABLES_OFF;
+		}
+		else
+		{
+			msg("gcc_rtti: unknown vtables mode '%s'\n", value.c_str());
+			return false;
+		}
+	}
+	else if (key == "overrides")
+	{
+		if (value == "comments")
+		{
+			m_overrides = OVERRIDES_COMMENTS;
+		}
+		else if (value == "names")
+		{
+			m_overrides = OVERRIDES_NAMES;
+		}
+		else if (is_flag)
+		{
+			m_overrides = flag ? OVERRIDES_COMMENTS : OVERRIDES_OFF;
+		}
+		else
+		{
+			msg("gcc_rtti: unknown overrides mode '%s'\n", value.c_str());
+			return false;
+		}
+	}
+	else
+	{
+		msg("gcc_rtti: unknown option '%s'\n", key.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+/* eof */
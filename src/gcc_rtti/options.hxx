@@ -0,0 +1,122 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#pragma once
+
+/**
+ * Plugin settings, read from plugin argument (-Ogcc_rtti:key=value;key=value;...) and optional config file
+ * (one key=value per line, '#' starts a comment). Later values override earlier ones.
+ * Flags take 0/1, on/off, true/false or yes/no, key alone turns flag on; other values are rejected.
+ *
+ * batch			- no UI at all, everything comes from options (also enabled by running plugin with arg 1)
+ * config=path		- load options from file
+ * ignore=a,b,c		- ignored prefixes of graph (default: std,type_info)
+ * output=path		- output path without extension, extension of every format is appended
+ * formats=dot,csv	- output formats (default: dot)
+ * summary=path		- file to which machine-readable summary is written (default: message window only)
+ * known_types=path	- load database of known library classes, they are recognized by name and not parsed in details
+ * known_types_fill	- fill bases of known classes from database instead of walking their type info
+ * known_types_save=path - save classes of this database as known types database
+ * ignore_known		- exclude known classes from graph (default: on)
+ * discovery=mode	- how references to type infos and vtables are found: scan (compare bytes of data segments),
+ *					  fixups (relocations only, fast for PIE and shared objects), auto (scan, and relocations if
+ *					  there are any, so pointers which are zero in file image are found too, default)
+ * symbols=mode		- use of _ZTI/_ZTV/_ZTS names: off, on (named objects are parsed first, data is scanned for the rest, default),
+ *					  only (trust names, do not scan data for type infos)
+ * vtables=mode	- look for vtables without type info (-fno-rtti): off, on, auto (only when no type info was found, default)
+ * snapshot_save=path - save class model (classes, bases, names and comments of vtable slots) for later diff
+ * diff=path		- compare classes with snapshot of previous build, report added, removed and changed classes
+ * diff_report=path	- file to which differences found by diff are written
+ * port_names		- port names of virtual methods and comments of vtable slots from snapshot given by diff (default: on)
+ * overrides=mode	- labels of vtable slots (introduced, overridden, inherited): comments (on vtable slots),
+ *					  names (of introduced and overriding methods, as Class__vfN), off (default); made by full run only
+ * structors		- find constructors and destructors by stores of vtables into this and name them Class__ctor/Class__dtor (default: off)
+ * layouts			- create structs with base subobjects and vptrs of every class, virtual bases are placed
+ *					  by vbase offsets from vtables (default: off)
+ * track			- keep classes up to date with later changes of database (default: on, interactive mode only)
+ * dry_run			- do not modify database and do not write output files
+ * exit				- exit IDA with status code after batch run
+ */
+class options_t
+{
+public:
+	enum discovery_t
+	{
+		DISCOVERY_AUTO = 0,
+		DISCOVERY_SCAN,
+		DISCOVERY_FIXUPS,
+	};
+
+	enum symbol_mode_t
+	{
+		SYMBOLS_OFF = 0,
+		SYMBOLS_ON,
+		SYMBOLS_ONLY,
+	};
+
+	enum overrides_mode_t
+	{
+		OVERRIDES_COMMENTS = 0,
+		OVERRIDES_NAMES,
+		OVERRIDES_OFF,
+	};
+
+	enum vtable_mode_t
+	{
+		VTABLES_AUTO = 0,
+		VTABLES_OFF,
+		VTABLES_ON,
+	};
+
+public:
+	options_t();
+
+	bool parse(const char *const text);
+	bool load_file(const char *const filepath);
+
+	bool has_format(const char *const format) const;
+
+private:
+	bool set(const sstring_t &key, const sstring_t &value);
+	static bool parse_flag(const sstring_t &value, bool &flag);
+
+public:
+	bool					m_batch;
+	bool					m_dry_run;
+	bool					m_exit;
+	bool					m_known_types_fill;
+	bool					m_ignore_known;
+	bool					m_track;
+	bool					m_port_names;
+	bool					m_structors;
+	bool					m_layouts;
+	discovery_t				m_discovery;
+	symbol_mode_t			m_symbols;
+	vtable_mode_t			m_vtables;
+	overrides_mode_t		m_overrides;
+	array_dyn_t<sstring_t>	m_ignored_prefixes;
+	array_dyn_t<sstring_t>	m_formats;
+	sstring_t				m_output;
+	sstring_t				m_summary;
+	sstring_t				m_known_types;
+	sstring_t				m_known_types_save;
+	sstring_t				m_snapshot_save;
+	sstring_t				m_diff;
+	sstring_t				m_diff_report;
+
+private:
+	static const uint MAX_CONFIG_DEPTH = 8; // config files including other ones
+
+	uint					m_config_depth;
+};
+
+/* eof */
@@ -0,0 +1,115 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#include <stdinc.hxx>
+
+#include "overrides.hxx"
+
+void overrides_t::build(const gcc_rtti_t &rtti, const hierarchy_t &hierarchy)
+{
+	clear();
+
+	const array_dyn_t<hierarchy_t::class_t *> &order = hierarchy.get_topological_order();
+	m_begin.reserve(order.size() + 1);
+
+	array_dyn_t<ea_t> slots;
+	for (unsigned int index = 0; index < order.size(); ++index)
+	{
+		const hierarchy_t::class_t *const c = order[index];
+		m_begin.push_back(m_targets.size());
+		if (!c)
+		{
+			continue; // removed by update
+		}
+
+		slots.clear();
+		rtti.get_vtable_slots(c, slots);
+
+		// primary base precedes class in topological order, so its slots are labeled already
+		const unsigned int base = find_primary_base(c, hierarchy);
+		const size_t base_first = (base != hierarchy_t::NO_INDEX) ? m_begin[base] : 0;
+		const size_t base_count = (base != hierarchy_t::NO_INDEX) ? m_begin[base + 1] - m_begin[base] : 0;
+
+		for (size_t slot = 0; slot < slots.size(); ++slot)
+		{
+			uchar kind = SLOT_INTRODUCED;
+			unsigned int origin = index;
+
+			if (slot < base_count)
+			{
+				kind = (m_targets[base_first + slot] == slots[slot]) ? SLOT_INHERITED : SLOT_OVERRIDDEN;
+				origin = m_origins[base_first + slot];
+			}
+
+			m_targets.push_back(slots[slot]);
+			m_kinds.push_back(kind);
+			m_origins.push_back(origin);
+		}
+	}
+
+	m_begin.push_back(m_targets.size());
+}
+
+void overrides_t::clear()
+{
+	m_targets.clear();
+	m_kinds.clear();
+	m_origins.clear();
+	m_begin.clear();
+}
+
+uint32 overrides_t::get_slot_count(const unsigned int order) const
+{
+	return static_cast<uint32>(m_begin[order + 1] - m_begin[order]);
+}
+
+ea_t overrides_t::get_target(const unsigned int order, const uint32 slot) const
+{
+	return m_targets[m_begin[order] + slot];
+}
+
+auto overrides_t::get_kind(const unsigned int order, const uint32 slot) const -> slot_kind_t
+{
+	return static_cast<slot_kind_t>(m_kinds[m_begin[order] + slot]);
+}
+
+unsigned int overrides_t::get_origin(const unsigned int order, const uint32 slot) const
+{
+	return m_origins[m_begin[order] + slot];
+}
+
+size_t overrides_t::size() const
+{
+	return m_targets.size();
+}
+
+unsigned int overrides_t::find_primary_base(const hierarchy_t::class_t *const c, const hierarchy_t &hierarchy) const
+{
+	// primary vtable of class starts with the one of its first dynamic non-virtual base at offset 0,
+	// empty base without vtable may be at offset 0 as well (struct D : Empty, Poly)
+	for (const hierarchy_t::class_t::base_t &base : c->m_bases)
+	{
+		if (!base.m_class || base.is_virtual() || base.m_offset != 0 || utils::is_bad_addr(base.m_class->m_vtable))
+		{
+			continue;
+		}
+
+		const unsigned int order = hierarchy.get_order(base.m_class);
+		if (order != hierarchy_t::NO_INDEX && order + 1 < m_begin.size() && m_begin[order + 1] > m_begin[order])
+		{
+			return order;
+		}
+	}
+	return hierarchy_t::NO_INDEX;
+}
+
+/* eof */
@@ -0,0 +1,57 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#pragma once
+
+#include "gcc_rtti.hxx"
+#include "hierarchy.hxx"
+
+/**
+ * Labels of primary vtable slots of every class, computed in single pass over topological order.
+ * Slots of class are compared with slots of its primary base (dynamic non-virtual base at offset 0), which
+ * is always labeled before: slot beyond base vtable is introduced, the same method is inherited,
+ * different one is overridden. Class which introduced the slot is carried over from base.
+ */
+class overrides_t
+{
+public:
+	enum slot_kind_t : uchar
+	{
+		SLOT_INTRODUCED = 0,
+		SLOT_OVERRIDDEN,
+		SLOT_INHERITED,
+		SLOT_COUNT /* always at end */
+	};
+
+public:
+	void build(const gcc_rtti_t &rtti, const hierarchy_t &hierarchy);
+	void clear();
+
+	/* classes are indexed by topological order of hierarchy */
+	uint32 get_slot_count(const unsigned int order) const;
+	ea_t get_target(const unsigned int order, const uint32 slot) const;
+	slot_kind_t get_kind(const unsigned int order, const uint32 slot) const;
+	unsigned int get_origin(const unsigned int order, const uint32 slot) const; // class which introduced the slot
+
+	size_t size() const;
+
+private:
+	unsigned int find_primary_base(const hierarchy_t::class_t *const c, const hierarchy_t &hierarchy) const;
+
+private:
+	array_dyn_t<ea_t>			m_targets;	// slots of all classes, one after another
+	array_dyn_t<uchar>			m_kinds;
+	array_dyn_t<unsigned int>	m_origins;
+	array_dyn_t<size_t>			m_begin;	// topological index -> first slot (count + 1 items)
+};
+
+/* eof */
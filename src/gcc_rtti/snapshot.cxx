@@ -0,0 +1,420 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#include <stdinc.hxx>
+
+#include "snapshot.hxx"
+
+static const char SNAPSHOT_MAGIC[4] = { 'G', 'R', 'S', 'N' };
+static const uint32 SNAPSHOT_VERSION = 1;
+
+const uint32 snapshot_t::NO_STRING;
+const uint32 snapshot_t::NO_INDEX;
+
+bool snapshot_t::load(const char *const filepath)
+{
+	clear();
+
+	array_dyn_t<uchar> data;
+	if (!utils::read_file(filepath, "snapshot", sizeof(header_t), data))
+	{
+		return false;
+	}
+
+	const header_t *const header = reinterpret_cast<const header_t *>(&data[0]);
+
+	const uint64 expected_size = sizeof(header_t)
+		+ static_cast<uint64>(header->m_class_count) * sizeof(record_t)
+		+ static_cast<uint64>(header->m_base_count) * sizeof(base_t)
+		+ static_cast<uint64>(header->m_slot_count) * sizeof(slot_t)
+		+ header->m_strings_size;
+
+	if (!utils::check_file(data, filepath, "snapshot", SNAPSHOT_MAGIC, SNAPSHOT_VERSION, expected_size, header->m_strings_size))
+	{
+		return false;
+	}
+
+	const uchar *current = &data[0] + sizeof(header_t);
+	const record_t *const records = reinterpret_cast<const record_t *>(current);
+	current += header->m_class_count * sizeof(record_t);
+	const base_t *const bases = reinterpret_cast<const base_t *>(current);
+	current += header->m_base_count * sizeof(base_t);
+	const slot_t *const slots = reinterpret_cast<const slot_t *>(current);
+	current += header->m_slot_count * sizeof(slot_t);
+	const char *const strings = reinterpret_cast<const char *>(current);
+
+	// validate references once, so comparison does not have to
+	const auto valid_string = [header](const uint32 offset, const bool optional)
+	{
+		return offset < header->m_strings_size || (optional && offset == NO_STRING);
+	};
+
+	bool valid = true;
+	for (uint32 i = 0; valid && i < header->m_class_count; ++i)
+	{
+		const record_t &record = records[i];
+		valid = valid_string(record.m_name, false)
+			&& valid_string(record.m_demangled, false)
+			&& record.m_first_base <= header->m_base_count
+			&& record.m_base_count <= header->m_base_count - record.m_first_base
+			&& record.m_first_slot <= header->m_slot_count
+			&& record.m_slot_count <= header->m_slot_count - record.m_first_slot;
+	}
+
+	for (uint32 i = 0; valid && i < header->m_base_count; ++i)
+	{
+		valid = bases[i].m_record < header->m_class_count;
+	}
+
+	for (uint32 i = 0; valid && i < header->m_slot_count; ++i)
+	{
+		valid = valid_string(slots[i].m_name, true) && valid_string(slots[i].m_comment, true);
+	}
+
+	if (!valid)
+	{
+		msg("Snapshot %s is corrupted\n", filepath);
+		return false;
+	}
+
+	m_records.insert(m_records.end(), records, records + header->m_class_count);
+	m_bases.insert(m_bases.end(), bases, bases + header->m_base_count);
+	m_slots.insert(m_slots.end(), slots, slots + header->m_slot_count);
+	m_strings.assign(strings, header->m_strings_size);
+	return true;
+}
+
+bool snapshot_t::save(const char *const filepath) const
+{
+	header_t header;
+	memcpy(header.m_magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+	header.m_version = SNAPSHOT_VERSION;
+	header.m_class_count = static_cast<uint32>(m_records.size());
+	header.m_base_count = static_cast<uint32>(m_bases.size());
+	header.m_slot_count = static_cast<uint32>(m_slots.size());
+	header.m_strings_size = m_strings.size();
+
+	FILE *const file = qfopen(filepath, "wb");
+	if (!file)
+	{
+		msg("Unable to open file %s for write!\n", filepath);
+		return false;
+	}
+
+	qfwrite(file, &header, sizeof(header));
+	if (!m_records.empty())
+	{
+		qfwrite(file, &m_records[0], m_records.size() * sizeof(record_t));
+	}
+	if (!m_bases.empty())
+	{
+		qfwrite(file, &m_bases[0], m_bases.size() * sizeof(base_t));
+	}
+	if (!m_slots.empty())
+	{
+		qfwrite(file, &m_slots[0], m_slots.size() * sizeof(slot_t));
+	}
+	qfwrite(file, m_strings.data(), m_strings.size());
+	qfclose(file);
+	return true;
+}
+
+void snapshot_t::collect(const gcc_rtti_t &rtti)
+{
+	using class_t = gcc_rtti_t::class_t;
+
+	clear();
+
+	array_dyn_t<const class_t *> classes;
+	hash_map_t<const class_t *, uint32> indices;
+
+	for (const auto &class_pair : rtti.get_classes())
+	{
+		const class_t *const c = class_pair.second.get();
+		if (!c)
+		{
+			continue;
+		}
+
+		// classes found without type info do not have mangled name, so their name is used instead
+		const sstring_t &name = c->m_mangled_name.empty() ? c->m_name : c->m_mangled_name;
+
+		record_t record;
+		record.m_name_hash = utils::hash_string(name.c_str());
+		record.m_hash = 0;
+		record.m_name = m_strings.add(name.c_str());
+		record.m_demangled = m_strings.add(c->m_name.c_str());
+		record.m_first_base = 0;
+		record.m_base_count = 0;
+		record.m_first_slot = 0;
+		record.m_slot_count = 0;
+
+		indices[c] = static_cast<uint32>(m_records.size());
+		m_records.push_back(record);
+		classes.push_back(c);
+	}
+
+	array_dyn_t<ea_t> targets;
+	for (uint32 index = 0; index < m_records.size(); ++index)
+	{
+		const class_t *const c = classes[index];
+		record_t &record = m_records[index];
+
+		uint64 hash = record.m_name_hash;
+
+		record.m_first_base = static_cast<uint32>(m_bases.size());
+		for (const class_t::base_t &base : c->m_bases)
+		{
+			const auto found = indices.find(base.m_class);
+			if (found == indices.end())
+			{
+				continue;
+			}
+
+			base_t record_base;
+			record_base.m_record = found->second;
+			record_base.m_offset = base.m_offset;
+			record_base.m_flags = base.m_flags;
+			m_bases.push_back(record_base);
+
+			hash = utils::hash_combine(hash, m_records[found->second].m_name_hash);
+			hash = utils::hash_combine(hash, base.m_offset);
+			hash = utils::hash_combine(hash, base.m_flags);
+		}
+		record.m_base_count = static_cast<uint32>(m_bases.size()) - record.m_first_base;
+
+		targets.clear();
+		rtti.get_vtable_slots(c, targets);
+
+		record.m_first_slot = static_cast<uint32>(m_slots.size());
+		record.m_slot_count = static_cast<uint32>(targets.size());
+		record.m_hash = utils::hash_combine(hash, record.m_slot_count);
+
+		for (uint32 i = 0; i < targets.size(); ++i)
+		{
+			const ea_t address = c->m_vtable + sizeof(ea_t) * (i + 1);
+
+			slot_t slot;
+			slot.m_name = NO_STRING;
+			slot.m_comment = NO_STRING;
+
+			// names and comments made by plugin are made again by next run, they are not ported
+			qstring text;
+			if (has_user_name(get_flags(targets[i])) && get_ea_name(&text, targets[i]) > 0 && !gcc_rtti_t::is_generated_name(text.c_str()))
+			{
+				slot.m_name = m_strings.add(text.c_str());
+			}
+
+			if (get_cmt(&text, address, false) > 0 && !gcc_rtti_t::is_generated_comment(text.c_str()))
+			{
+				slot.m_comment = m_strings.add(text.c_str());
+			}
+
+			m_slots.push_back(slot);
+			m_slot_addresses.push_back(address);
+			m_slot_targets.push_back(targets[i]);
+		}
+	}
+
+	if (m_strings.empty())
+	{
+		m_strings.add(""); // file always ends with zero
+	}
+}
+
+void snapshot_t::compare(snapshot_t &current, const bool port, const bool dry_run, diff_t &diff) const
+{
+	// previous classes by hash of name, the same names (type info emitted more than once) are chained in order
+	hash_map_t<uint64, uint32> by_name;
+	array_dyn_t<uint32> next_same;
+	next_same.resize(m_records.size(), NO_INDEX);
+
+	for (uint32 index = static_cast<uint32>(m_records.size()); index-- > 0;)
+	{
+		const auto inserted = by_name.emplace(m_records[index].m_name_hash, index);
+		if (!inserted.second)
+		{
+			next_same[index] = inserted.first->second;
+			inserted.first->second = index;
+		}
+	}
+
+	array_dyn_t<bool> matched;
+	matched.resize(m_records.size(), false);
+
+	for (const record_t &record : current.m_records)
+	{
+		const char *const name = current.m_strings.get(record.m_name);
+
+		uint32 index = NO_INDEX;
+		const auto found = by_name.find(record.m_name_hash);
+		if (found != by_name.end())
+		{
+			for (index = found->second; index != NO_INDEX; index = next_same[index])
+			{
+				if (!matched[index] && strcmp(m_strings.get(m_records[index].m_name), name) == 0)
+				{
+					break;
+				}
+			}
+		}
+
+		if (index == NO_INDEX)
+		{
+			++diff.m_added;
+			diff.m_report.push_back(sstring_t("+ ") + current.m_strings.get(record.m_demangled));
+			continue;
+		}
+
+		matched[index] = true;
+		const record_t &previous = m_records[index];
+
+		if (previous.m_hash == record.m_hash)
+		{
+			++diff.m_unchanged;
+		}
+		else
+		{
+			++diff.m_changed;
+			diff.m_report.push_back(sstring_t("* ") + current.m_strings.get(record.m_demangled));
+
+			if (previous.m_slot_count != record.m_slot_count)
+			{
+				sstring_t line;
+				line.sprnt("  slots: %u -> %u", previous.m_slot_count, record.m_slot_count);
+				diff.m_report.push_back(line);
+			}
+
+			compare_bases(previous, current, record, diff);
+		}
+
+		if (port)
+		{
+			port_slots(previous, current, record, dry_run, diff);
+		}
+	}
+
+	for (uint32 index = 0; index < m_records.size(); ++index)
+	{
+		if (!matched[index])
+		{
+			++diff.m_removed;
+			diff.m_report.push_back(sstring_t("- ") + m_strings.get(m_records[index].m_demangled));
+		}
+	}
+}
+
+uint32 snapshot_t::size() const
+{
+	return static_cast<uint32>(m_records.size());
+}
+
+void snapshot_t::clear()
+{
+	m_records.clear();
+	m_bases.clear();
+	m_slots.clear();
+	m_strings.clear();
+	m_slot_addresses.clear();
+	m_slot_targets.clear();
+}
+
+sstring_t snapshot_t::describe_base(const base_t &base) const
+{
+	sstring_t text;
+	text.sprnt("%s at 0x%X%s", m_strings.get(m_records[base.m_record].m_demangled), base.m_offset,
+		(base.m_flags & gcc_rtti_t::class_t::base_t::FLAG_VIRTUAL) ? " (virtual)" : "");
+	return text;
+}
+
+void snapshot_t::compare_bases(const record_t &previous, const snapshot_t &current, const record_t &record, diff_t &diff) const
+{
+	// classes have just a few bases, so they are compared directly
+	const auto same = [](const snapshot_t &lhs, const base_t &lhs_base, const snapshot_t &rhs, const base_t &rhs_base)
+	{
+		return lhs.m_records[lhs_base.m_record].m_name_hash == rhs.m_records[rhs_base.m_record].m_name_hash
+			&& lhs_base.m_offset == rhs_base.m_offset
+			&& lhs_base.m_flags == rhs_base.m_flags;
+	};
+
+	for (uint32 i = 0; i < previous.m_base_count; ++i)
+	{
+		const base_t &base = m_bases[previous.m_first_base + i];
+
+		bool found = false;
+		for (uint32 j = 0; !found && j < record.m_base_count; ++j)
+		{
+			found = same(*this, base, current, current.m_bases[record.m_first_base + j]);
+		}
+
+		if (!found)
+		{
+			diff.m_report.push_back(sstring_t("  - base ") + describe_base(base));
+		}
+	}
+
+	for (uint32 j = 0; j < record.m_base_count; ++j)
+	{
+		const base_t &base = current.m_bases[record.m_first_base + j];
+
+		bool found = false;
+		for (uint32 i = 0; !found && i < previous.m_base_count; ++i)
+		{
+			found = same(current, base, *this, m_bases[previous.m_first_base + i]);
+		}
+
+		if (!found)
+		{
+			diff.m_report.push_back(sstring_t("  + base ") + current.describe_base(base));
+		}
+	}
+}
+
+void snapshot_t::port_slots(const record_t &previous, snapshot_t &current, const record_t &record, const bool dry_run, diff_t &diff) const
+{
+	// slots are matched by index, so it is safe only when their count has not changed
+	if (previous.m_slot_count != record.m_slot_count)
+	{
+		return;
+	}
+
+	for (uint32 i = 0; i < record.m_slot_count; ++i)
+	{
+		const slot_t &slot = m_slots[previous.m_first_slot + i];
+		slot_t &current_slot = current.m_slots[record.m_first_slot + i];
+		const ea_t address = current.m_slot_addresses[record.m_first_slot + i];
+		const ea_t target = current.m_slot_targets[record.m_first_slot + i];
+
+		// names and comments given in current database are never overwritten
+		if (slot.m_name != NO_STRING && current_slot.m_name == NO_STRING && !has_user_name(get_flags(target)))
+		{
+			const char *const name = m_strings.get(slot.m_name);
+			if (dry_run || set_name(target, name, SN_NOWARN))
+			{
+				current_slot.m_name = current.m_strings.add(name);
+				++diff.m_ported_names;
+			}
+		}
+
+		if (slot.m_comment != NO_STRING && current_slot.m_comment == NO_STRING)
+		{
+			const char *const comment = m_strings.get(slot.m_comment);
+			if (dry_run || set_cmt(address, comment, false))
+			{
+				current_slot.m_comment = current.m_strings.add(comment);
+				++diff.m_ported_comments;
+			}
+		}
+	}
+}
+
+/* eof */
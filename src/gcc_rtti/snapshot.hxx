@@ -0,0 +1,115 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#pragma once
+
+#include "gcc_rtti.hxx"
+
+/**
+ * Class model of a database (classes, bases, vtable slots with user names and comments) saved in compact form,
+ * so next build of the same product can be compared with it (snapshot_save and diff options).
+ * Classes are matched through hash tables: by mangled name and then by hash of mangled name,
+ * base structure and vtable slot count, so classes which are not changed are found by single lookup.
+ *
+ * File layout:
+ *   header_t
+ *   record_t[header_t::m_class_count]
+ *   base_t[header_t::m_base_count]
+ *   slot_t[header_t::m_slot_count]
+ *   char[header_t::m_strings_size]		- zero terminated strings
+ */
+class snapshot_t
+{
+public:
+	static const uint32 NO_STRING = static_cast<uint32>(-1);
+	static const uint32 NO_INDEX = static_cast<uint32>(-1);
+
+	class header_t
+	{
+	public:
+		char	m_magic[4];
+		uint32	m_version;
+		uint32	m_class_count;
+		uint32	m_base_count;
+		uint32	m_slot_count;
+		uint32	m_strings_size;
+	};
+
+	class record_t
+	{
+	public:
+		uint64	m_name_hash;	// utils::hash_string() of mangled name (name of class without type info)
+		uint64	m_hash;			// m_name_hash combined with bases and slot count
+		uint32	m_name;			// mangled name
+		uint32	m_demangled;
+		uint32	m_first_base;
+		uint32	m_base_count;
+		uint32	m_first_slot;
+		uint32	m_slot_count;
+	};
+
+	class base_t
+	{
+	public:
+		uint32	m_record;		// index of base class
+		uint32	m_offset;
+		uint32	m_flags;
+	};
+
+	class slot_t
+	{
+	public:
+		uint32	m_name;			// user name of virtual method, NO_STRING if it has none
+		uint32	m_comment;		// comment of vtable slot, NO_STRING if it has none
+	};
+
+	/* result of compare() */
+	class diff_t
+	{
+	public:
+		uint	m_added = 0;
+		uint	m_removed = 0;
+		uint	m_changed = 0;
+		uint	m_unchanged = 0;
+		uint	m_ported_names = 0;
+		uint	m_ported_comments = 0;
+		array_dyn_t<sstring_t> m_report; // one line per difference
+	};
+
+public:
+	bool load(const char *const filepath);
+	bool save(const char *const filepath) const;
+
+	/* builds model of current database, slot addresses are remembered for porting */
+	void collect(const gcc_rtti_t &rtti);
+
+	/* compares current model with this (previous) one, ports names and comments of slots of matched classes */
+	void compare(snapshot_t &current, const bool port, const bool dry_run, diff_t &diff) const;
+
+	uint32 size() const;
+
+private:
+	void clear();
+	sstring_t describe_base(const base_t &base) const;
+	void compare_bases(const record_t &previous, const snapshot_t &current, const record_t &record, diff_t &diff) const;
+	void port_slots(const record_t &previous, snapshot_t &current, const record_t &record, const bool dry_run, diff_t &diff) const;
+
+private:
+	array_dyn_t<record_t>	m_records;
+	array_dyn_t<base_t>		m_bases;
+	array_dyn_t<slot_t>		m_slots;
+	utils::string_pool_t	m_strings;
+	array_dyn_t<ea_t>		m_slot_addresses;	// current database only, address of every slot in vtable
+	array_dyn_t<ea_t>		m_slot_targets;		// current database only, virtual method of every slot
+};
+
+/* eof */
@@ -19,6 +19,7 @@
 #include <algorithm>	// for std::remove_if
 #include <map>			// for std::map<>
 #include <memory>		// for std::unique_ptr<>
+#include <unordered_map>	// for std::unordered_map<>
 
 #define USE_STANDARD_FILE_FUNCTIONS // allow using stdin, stdout, etc.
 
@@ -34,10 +35,13 @@
 #include <typeinf.hpp>
 #include <allins.hpp>
 #include <strlist.hpp>
+#include <struct.hpp>
 #include <segment.hpp>
 #include <diskio.hpp>
 #include <pro.h>
 #include <dbg.hpp>
+#include <expr.hpp>
+#include <fixup.hpp>
 #include <idd.hpp>
 
 /* aliases of types */
@@ -47,6 +51,9 @@ using array_dyn_t	= qvector<T>;	// may use also std::vector instead which allows
 template < typename Tkey, typename Tvalue >
 using map_t			= std::map<Tkey, Tvalue>; // there is no idaapi equivalent, so use std::map<> instead
 
+template < typename Tkey, typename Tvalue >
+using hash_map_t	= std::unordered_map<Tkey, Tvalue>; // for large lookup tables, where ordering is not needed
+
 using string		= const char *;		// simple c-string
 using sstring_t		= qstring;			// sstring stands for smart string
 
@@ -0,0 +1,354 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#include <stdinc.hxx>
+
+#include "structors.hxx"
+
+void structors_t::build(const gcc_rtti_t &rtti)
+{
+	clear();
+
+	array_dyn_t<ea_t> slots;
+	for (const auto &class_pair : rtti.get_classes())
+	{
+		class_t *const c = class_pair.second.get();
+		if (!c || utils::is_bad_addr(c->m_vtable))
+		{
+			continue;
+		}
+
+		// address point is usually referenced directly, sometimes vtable start with added offset
+		m_address_points.emplace(c->m_vtable + sizeof(ea_t), c);
+		m_address_points.emplace(c->m_vtable - sizeof(ea_t), c);
+
+		slots.clear();
+		rtti.get_vtable_slots(c, slots);
+		for (const ea_t slot : slots)
+		{
+			m_slots.emplace(slot, c);
+		}
+	}
+
+	if (m_address_points.empty())
+	{
+		return;
+	}
+
+	// single sweep over data references of all functions
+	hash_map_t<ea_t, class_t *> references;
+	array_dyn_t<store_t> stores;
+	const size_t function_count = get_func_qty();
+
+	for (size_t i = 0; i < function_count; ++i)
+	{
+		func_t *const function = getn_func(i);
+		if (!function)
+		{
+			continue;
+		}
+
+		references.clear();
+
+		func_item_iterator_t items;
+		for (bool ok = items.set(function); ok; ok = items.next_code())
+		{
+			const ea_t address = items.current();
+
+			xrefblk_t xb;
+			for (bool xb_ok = xb.first_from(address, XREF_DATA); xb_ok; xb_ok = xb.next_from())
+			{
+				const auto found = m_address_points.find(xb.to);
+				if (found != m_address_points.end())
+				{
+					references.emplace(address, found->second);
+				}
+			}
+		}
+
+		if (references.empty())
+		{
+			continue;
+		}
+
+		// instructions are decoded only in functions which refer some address point
+		stores.clear();
+		find_stores(function, references, stores);
+
+		if (!stores.empty())
+		{
+			classify(function->start_ea, stores);
+		}
+	}
+
+	// with virtual destructor known, the other functions of class can be only constructors
+	hash_map_t<const class_t *, bool> virtual_destructors;
+	for (const structor_t &structor : m_structors)
+	{
+		if (structor.m_kind == KIND_DESTRUCTOR)
+		{
+			virtual_destructors.emplace(structor.m_class, true);
+		}
+	}
+
+	for (structor_t &structor : m_structors)
+	{
+		if (structor.m_kind == KIND_UNKNOWN && virtual_destructors.find(structor.m_class) != virtual_destructors.end())
+		{
+			structor.m_kind = KIND_CONSTRUCTOR;
+		}
+	}
+}
+
+void structors_t::clear()
+{
+	m_address_points.clear();
+	m_slots.clear();
+	m_structors.clear();
+}
+
+auto structors_t::get_structors() const -> const array_dyn_t<structor_t> &
+{
+	return m_structors;
+}
+
+/* register numbers of IDA x86 processor module (intel.hpp) */
+enum
+{
+	REG_AX = 0, REG_CX, REG_DX, REG_BX, REG_SP, REG_BP, REG_SI, REG_DI,
+	REG_R8, REG_R9, REG_R10, REG_R11, REG_R12, REG_R13, REG_R14, REG_R15,
+	REG_NONE = -1,
+};
+
+static bool is_memory(const op_t &op)
+{
+	return op.type == o_phrase || op.type == o_displ;
+}
+
+static int get_base_reg(const insn_t &insn, const op_t &op)
+{
+	// op.specflag1 - operand has SIB byte (op.specflag2), insn.insnpref - REX prefix
+	if (op.specflag1)
+	{
+		return (op.specflag2 & 7) | ((insn.insnpref & 1) ? 8 : 0);
+	}
+	return op.phrase;
+}
+
+static bool has_index_reg(const insn_t &insn, const op_t &op)
+{
+	// index 4 without REX.X means no index
+	return op.specflag1 && (((op.specflag2 >> 3) & 7) != REG_SP || (insn.insnpref & 2) != 0);
+}
+
+static sval_t get_displacement(const op_t &op)
+{
+	return op.type == o_displ ? static_cast<sval_t>(op.addr) : 0;
+}
+
+void structors_t::find_stores(func_t *const function, const hash_map_t<ea_t, class_t *> &references, array_dyn_t<store_t> &stores) const
+{
+	registers_t registers;
+	for (int reg = 0; reg < REG_COUNT; ++reg)
+	{
+		registers.m_this[reg] = NOT_THIS;
+		registers.m_vtable[reg] = nullptr;
+	}
+
+	// this is the first argument (System V ABI on x64; regparm or stack on x86)
+	registers.m_this[inf.is_64bit() ? REG_DI : REG_CX] = 0;
+
+	// function is walked from its start, until the last address point could have been stored
+	size_t remaining = references.size();
+	int distance = 0;
+
+	func_item_iterator_t items;
+	for (bool ok = items.set(function); ok && distance < MAX_STORE_DISTANCE; ok = items.next_code())
+	{
+		const ea_t address = items.current();
+
+		insn_t insn;
+		if (decode_insn(&insn, address) <= 0)
+		{
+			continue;
+		}
+
+		const auto found = references.find(address);
+		class_t *const referenced = (found != references.end()) ? found->second : nullptr;
+
+		step(function, insn, referenced, registers, stores);
+
+		if (referenced)
+		{
+			--remaining;
+		}
+		if (remaining == 0)
+		{
+			++distance;
+		}
+	}
+}
+
+void structors_t::step(func_t *const function, const insn_t &insn, class_t *const referenced, registers_t &registers, array_dyn_t<store_t> &stores) const
+{
+	const op_t &destination = insn.ops[0];
+	const op_t &source = insn.ops[1];
+
+	// mov [reg+offset], offset vtable / mov [reg+offset], reg
+	if (insn.itype == NN_mov && is_memory(destination))
+	{
+		class_t *const stored = referenced ? referenced
+			: (source.type == o_reg && source.reg < REG_COUNT) ? registers.m_vtable[source.reg] : nullptr;
+
+		const int base = get_base_reg(insn, destination);
+		if (stored && base >= 0 && base < REG_COUNT && !has_index_reg(insn, destination) && registers.m_this[base] != NOT_THIS)
+		{
+			stores.push_back(store_t{ stored, registers.m_this[base] + get_displacement(destination) });
+		}
+		return; // only memory is written
+	}
+
+	if (insn.itype == NN_call || insn.itype == NN_callni || insn.itype == NN_callfi)
+	{
+		// caller saved registers do not survive call
+		static const int clobbered_64[] = { REG_AX, REG_CX, REG_DX, REG_SI, REG_DI, REG_R8, REG_R9, REG_R10, REG_R11 };
+		static const int clobbered_32[] = { REG_AX, REG_CX, REG_DX };
+
+		const int *const clobbered = inf.is_64bit() ? clobbered_64 : clobbered_32;
+		const size_t count = inf.is_64bit() ? qnumber(clobbered_64) : qnumber(clobbered_32);
+		for (size_t i = 0; i < count; ++i)
+		{
+			registers.m_this[clobbered[i]] = NOT_THIS;
+			registers.m_vtable[clobbered[i]] = nullptr;
+		}
+		return;
+	}
+
+	if (destination.type != o_reg || destination.reg >= REG_COUNT
+	 || insn.itype == NN_push || insn.itype == NN_cmp || insn.itype == NN_test)
+	{
+		return; // no register is written
+	}
+
+	const uint16 reg = destination.reg;
+	sval_t this_offset = NOT_THIS;
+	class_t *vtable = nullptr;
+
+	switch (insn.itype)
+	{
+		case NN_mov:
+			if (referenced)
+			{
+				vtable = referenced; // mov reg, offset vtable
+			}
+			else if (source.type == o_reg && source.reg < REG_COUNT)
+			{
+				this_offset = registers.m_this[source.reg];
+				vtable = registers.m_vtable[source.reg];
+			}
+			else if (is_this_argument(function, insn, source))
+			{
+				this_offset = 0;
+			}
+			break;
+
+		case NN_lea:
+			if (referenced)
+			{
+				vtable = referenced; // lea reg, vtable (position independent code)
+			}
+			else if (is_memory(source) && !has_index_reg(insn, source))
+			{
+				// this of base subobject
+				const int base = get_base_reg(insn, source);
+				if (base >= 0 && base < REG_COUNT && registers.m_this[base] != NOT_THIS)
+				{
+					this_offset = registers.m_this[base] + get_displacement(source);
+				}
+			}
+			break;
+
+		case NN_add:
+		case NN_sub:
+			if (source.type == o_imm)
+			{
+				// vtable start plus offset is address point of the same class
+				const sval_t delta = insn.itype == NN_add ? static_cast<sval_t>(source.value) : -static_cast<sval_t>(source.value);
+				this_offset = registers.m_this[reg] != NOT_THIS ? registers.m_this[reg] + delta : NOT_THIS;
+				vtable = registers.m_vtable[reg];
+			}
+			break;
+
+		default:
+			break; // register is overwritten by something else
+	}
+
+	registers.m_this[reg] = this_offset;
+	registers.m_vtable[reg] = vtable;
+}
+
+bool structors_t::is_this_argument(func_t *const function, const insn_t &insn, const op_t &op) const
+{
+	// on x86 without regparm this is passed on stack: [esp+4] at entry, [ebp+8] after frame is set up
+	if (inf.is_64bit() || op.type != o_displ || has_index_reg(insn, op))
+	{
+		return false;
+	}
+
+	const int base = get_base_reg(insn, op);
+	if (base == REG_SP)
+	{
+		return get_displacement(op) + get_spd(function, insn.ea) == static_cast<sval_t>(sizeof(ea_t));
+	}
+	if (base == REG_BP && (function->flags & FUNC_FRAME) != 0)
+	{
+		return get_displacement(op) == static_cast<sval_t>(sizeof(ea_t) * 2);
+	}
+	return false;
+}
+
+void structors_t::classify(const ea_t function, const array_dyn_t<store_t> &stores)
+{
+	// destructor is a slot of vtable of its own class
+	const auto slot = m_slots.find(function);
+	if (slot != m_slots.end())
+	{
+		class_t *const owner = slot->second;
+		const bool stored = std::any_of(stores.begin(), stores.end(), [owner](const store_t &store)
+		{
+			return store.m_class == owner && store.m_offset == 0;
+		});
+
+		if (stored)
+		{
+			m_structors.push_back(structor_t{ function, owner, KIND_DESTRUCTOR });
+			return;
+		}
+	}
+
+	// stores of inlined base constructors come before the own one
+	class_t *owner = nullptr;
+	for (const store_t &store : stores)
+	{
+		if (store.m_offset == 0)
+		{
+			owner = store.m_class;
+		}
+	}
+
+	if (owner)
+	{
+		m_structors.push_back(structor_t{ function, owner, KIND_UNKNOWN });
+	}
+}
+
+/* eof */
@@ -0,0 +1,90 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#pragma once
+
+#include "gcc_rtti.hxx"
+
+/**
+ * Constructors and destructors found by stores of vtable address points into objects.
+ * Address points of all classes are put into single hash table and data references of all functions
+ * are visited once, so there is no cross reference walk per class.
+ *
+ * Only stores into this count: functions which refer address point are walked from their start and registers
+ * holding this (first argument: rdi on x64, ecx or [esp+4] on x86) or this plus offset are tracked, so stores
+ * into objects on stack or returned by inlined new are not taken. When base constructor is inlined more
+ * address points are stored at offset 0, then the last one belongs to the function.
+ *
+ * Function which is a slot of vtable it stores is a destructor (the only virtual method which sets vptr).
+ * Other ones are constructors only if class has virtual destructor, otherwise they may be non-virtual
+ * destructors as well, which store vtable in the same way.
+ */
+class structors_t
+{
+public:
+	using class_t = gcc_rtti_t::class_t;
+
+	enum kind_t : uchar
+	{
+		KIND_CONSTRUCTOR = 0,
+		KIND_DESTRUCTOR,
+		KIND_UNKNOWN,	// constructor or non-virtual destructor
+		KIND_COUNT /* always at end */
+	};
+
+	class structor_t
+	{
+	public:
+		ea_t		m_function;
+		class_t		*m_class;
+		kind_t		m_kind;
+	};
+
+public:
+	void build(const gcc_rtti_t &rtti);
+	void clear();
+
+	const array_dyn_t<structor_t> &get_structors() const;
+
+private:
+	class store_t
+	{
+	public:
+		class_t		*m_class;
+		sval_t		m_offset;	// offset in object at which address point is stored
+	};
+
+	static const int REG_COUNT = 16;				// general purpose registers, as numbered by IDA x86 module
+	static const sval_t NOT_THIS = SVAL_MIN;
+
+	/* what registers hold while function is walked */
+	class registers_t
+	{
+	public:
+		sval_t		m_this[REG_COUNT];		// offset from this, NOT_THIS if register does not hold this
+		class_t		*m_vtable[REG_COUNT];	// class whose address point is in register
+	};
+
+	void find_stores(func_t *const function, const hash_map_t<ea_t, class_t *> &references, array_dyn_t<store_t> &stores) const;
+	void step(func_t *const function, const insn_t &insn, class_t *const referenced, registers_t &registers, array_dyn_t<store_t> &stores) const;
+	bool is_this_argument(func_t *const function, const insn_t &insn, const op_t &op) const;
+	void classify(const ea_t function, const array_dyn_t<store_t> &stores);
+
+private:
+	static const int MAX_STORE_DISTANCE = 4; // instructions between loading the last address point and storing it
+
+	hash_map_t<ea_t, class_t *>		m_address_points;	// address point (and vtable start) -> class
+	hash_map_t<ea_t, class_t *>		m_slots;			// virtual method -> class of first vtable which has it
+	array_dyn_t<structor_t>			m_structors;
+};
+
+/* eof */
@@ -0,0 +1,170 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#include <stdinc.hxx>
+
+#include <utils.hxx>
+
+#include "symbols.hxx"
+
+void symbols_t::build()
+{
+	clear();
+
+	const size_t count = get_nlist_size();
+	for (size_t i = 0; i < count; ++i)
+	{
+		const char *name = get_nlist_name(i);
+		if (!name)
+		{
+			continue;
+		}
+
+		// __ZTI is used by plugin and by Mach-O symbols
+		if (name[0] == '_' && name[1] == '_')
+		{
+			++name;
+		}
+
+		if (name[0] != '_' || name[1] != 'Z' || name[2] != 'T' || name[3] == '\0' || name[4] == '\0')
+		{
+			continue;
+		}
+
+		const ea_t address = get_nlist_ea(i);
+
+		switch (name[3])
+		{
+			case 'I':
+				if (add(m_type_info_by_name, &name[4], address))
+				{
+					m_type_infos.push_back(address);
+				}
+				break;
+
+			case 'V':
+				m_vtables_count += add(m_vtable_by_name, &name[4], address) ? 1 : 0;
+				break;
+
+			case 'S':
+				m_type_names_count += add(m_type_name_by_name, &name[4], address) ? 1 : 0;
+				break;
+
+			default:
+				break; // VTT, construction vtables, etc.
+		}
+	}
+}
+
+void symbols_t::clear()
+{
+	m_type_infos.clear();
+	m_symbols.clear();
+	m_names.clear();
+	m_type_info_by_name.clear();
+	m_vtable_by_name.clear();
+	m_type_name_by_name.clear();
+	m_vtables_count = 0;
+	m_type_names_count = 0;
+}
+
+bool symbols_t::empty() const
+{
+	return m_type_infos.empty() && m_vtable_by_name.empty() && m_type_name_by_name.empty();
+}
+
+const array_dyn_t<ea_t> &symbols_t::get_type_infos() const
+{
+	return m_type_infos;
+}
+
+size_t symbols_t::get_vtables_count() const
+{
+	return m_vtables_count;
+}
+
+size_t symbols_t::get_type_names_count() const
+{
+	return m_type_names_count;
+}
+
+ea_t symbols_t::find_type_info(const char *const mangled_name) const
+{
+	return find(m_type_info_by_name, mangled_name);
+}
+
+ea_t symbols_t::find_vtable(const char *const mangled_name) const
+{
+	return find(m_vtable_by_name, mangled_name);
+}
+
+ea_t symbols_t::find_type_name(const char *const mangled_name) const
+{
+	return find(m_type_name_by_name, mangled_name);
+}
+
+bool symbols_t::add(index_t &index, const char *const mangled_name, const ea_t address)
+{
+	const uint64 hash = utils::hash_string(mangled_name);
+
+	// the same name more times (i.e. symbol and name made by plugin), the first one is kept
+	// last symbol of chain is kept by index, pointer into m_symbols would not survive push_back below
+	uint32 tail = NO_SYMBOL;
+	const auto found = index.find(hash);
+	if (found != index.end())
+	{
+		for (uint32 symbol = found->second; symbol != NO_SYMBOL; symbol = m_symbols[symbol].m_next)
+		{
+			if (strcmp(m_names.get(m_symbols[symbol].m_name), mangled_name) == 0)
+			{
+				return false;
+			}
+			tail = symbol;
+		}
+	}
+
+	const uint32 name = m_names.add(mangled_name);
+
+	const uint32 symbol = static_cast<uint32>(m_symbols.size());
+	m_symbols.push_back(symbol_t{ address, name, NO_SYMBOL });
+
+	if (tail != NO_SYMBOL)
+	{
+		m_symbols[tail].m_next = symbol;
+	}
+	else
+	{
+		index.emplace(hash, symbol);
+	}
+	return true;
+}
+
+ea_t symbols_t::find(const index_t &index, const char *const mangled_name) const
+{
+	const auto found = index.find(utils::hash_string(mangled_name));
+	if (found == index.end())
+	{
+		return BADADDR;
+	}
+
+	// different names may have the same hash
+	for (uint32 symbol = found->second; symbol != NO_SYMBOL; symbol = m_symbols[symbol].m_next)
+	{
+		if (strcmp(m_names.get(m_symbols[symbol].m_name), mangled_name) == 0)
+		{
+			return m_symbols[symbol].m_address;
+		}
+	}
+	return BADADDR;
+}
+
+/* eof */
@@ -0,0 +1,66 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#pragma once
+
+/**
+ * Type info related symbols (_ZTI - type info, _ZTV - vtable, _ZTS - type name) taken from names list.
+ * Binaries with symbols have all of them named already, so there is no need to look for them in data.
+ * Names made by plugin itself (with additional leading underscore) are accepted too.
+ * Symbols are found by hash of mangled name, hit is verified by comparing the name itself.
+ */
+class symbols_t
+{
+public:
+	void build();
+	void clear();
+
+	bool empty() const;
+
+	/* all _ZTI symbols, in order of names list */
+	const array_dyn_t<ea_t> &get_type_infos() const;
+	size_t get_vtables_count() const;
+	size_t get_type_names_count() const;
+
+	/* address of symbol for given mangled name (without _ZT? prefix), BADADDR if there is none */
+	ea_t find_type_info(const char *const mangled_name) const;
+	ea_t find_vtable(const char *const mangled_name) const;
+	ea_t find_type_name(const char *const mangled_name) const;
+
+private:
+	using index_t = hash_map_t<uint64, uint32>; // utils::hash_string() of mangled name -> first symbol with that hash
+
+	class symbol_t
+	{
+	public:
+		ea_t	m_address;
+		uint32	m_name;	// offset of mangled name in m_names
+		uint32	m_next;	// next symbol with the same hash (collision), NO_SYMBOL at end
+	};
+
+	bool add(index_t &index, const char *const mangled_name, const ea_t address);
+	ea_t find(const index_t &index, const char *const mangled_name) const;
+
+private:
+	static const uint32 NO_SYMBOL = static_cast<uint32>(-1);
+
+	array_dyn_t<ea_t>			m_type_infos;
+	array_dyn_t<symbol_t>		m_symbols;			// of all kinds
+	utils::string_pool_t		m_names;			// mangled names
+	index_t						m_type_info_by_name;
+	index_t						m_vtable_by_name;
+	index_t						m_type_name_by_name;
+	size_t						m_vtables_count = 0;
+	size_t						m_type_names_count = 0;
+};
+
+/* eof */
@@ -0,0 +1,194 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#include <stdinc.hxx>
+
+#include "tracker.hxx"
+
+tracker_t::tracker_t()
+	: m_timer(nullptr)
+	, m_refresh_ticks(0)
+	, m_active(false)
+	, m_updating(false)
+	, m_settling(false)
+{
+}
+
+tracker_t::~tracker_t()
+{
+	stop();
+}
+
+void tracker_t::start()
+{
+	if (m_active)
+	{
+		return;
+	}
+
+	m_dirty.clear();
+	m_dirty_segments.clear();
+	m_own.clear();
+	m_settling = false;
+	m_refresh_ticks = 0;
+
+	hook_to_notification_point(HT_IDB, &tracker_t::idb_event_s, this);
+	m_timer = register_timer(TIMER_INTERVAL, &tracker_t::timer_s, this);
+	m_active = true;
+}
+
+void tracker_t::stop()
+{
+	if (!m_active)
+	{
+		return;
+	}
+
+	unhook_from_notification_point(HT_IDB, &tracker_t::idb_event_s, this);
+	if (m_timer)
+	{
+		unregister_timer(m_timer);
+		m_timer = nullptr;
+	}
+
+	m_dirty.clear();
+	m_dirty_segments.clear();
+	m_own.clear();
+	m_settling = false;
+	m_active = false;
+}
+
+ssize_t idaapi tracker_t::idb_event_s(void *user_data, int code, va_list va)
+{
+	static_cast<tracker_t *>(user_data)->on_idb_event(code, va);
+	return 0;
+}
+
+int idaapi tracker_t::timer_s(void *user_data)
+{
+	static_cast<tracker_t *>(user_data)->process();
+	return TIMER_INTERVAL;
+}
+
+void tracker_t::on_idb_event(const int code, va_list va)
+{
+	if (m_updating)
+	{
+		return;
+	}
+
+	switch (code)
+	{
+		case idb_event::segm_added:
+		{
+			const segment_t *const segment = va_arg(va, segment_t *);
+			m_dirty_segments.add(range_t(segment->start_ea, segment->end_ea));
+			break;
+		}
+
+		case idb_event::segm_moved:
+		{
+			const ea_t from = va_arg(va, ea_t);
+			const ea_t to = va_arg(va, ea_t);
+			const asize_t size = va_arg(va, asize_t);
+			m_dirty_segments.add(range_t(from, from + size));
+			m_dirty_segments.add(range_t(to, to + size));
+			break;
+		}
+
+		case idb_event::byte_patched:
+		{
+			const ea_t address = va_arg(va, ea_t);
+			mark_dirty(range_t(address, address + 1));
+			break;
+		}
+
+		case idb_event::make_data:
+		{
+			const ea_t address = va_arg(va, ea_t);
+			va_arg(va, flags_t);	// flags
+			va_arg(va, tid_t);		// tid
+			const asize_t size = va_arg(va, asize_t);
+			mark_dirty(range_t(address, address + (size ? size : 1)));
+			break;
+		}
+
+		case idb_event::destroyed_items:
+		{
+			const ea_t start = va_arg(va, ea_t);
+			const ea_t end = va_arg(va, ea_t);
+			if (start < end)
+			{
+				mark_dirty(range_t(start, end));
+			}
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+void tracker_t::mark_dirty(const range_t &range)
+{
+	// auto analysis of what plugin formatted in last update, not a change made by user
+	if (m_settling && m_own.has_common(range))
+	{
+		return;
+	}
+	m_dirty.add(range);
+}
+
+void tracker_t::process()
+{
+	if (!auto_is_ok())
+	{
+		return; // analysis is still running, so more changes will come
+	}
+
+	// queue has drained, so all changes caused by last update have been seen already
+	if (m_settling)
+	{
+		m_settling = false;
+		m_own.clear();
+	}
+
+	gcc_rtti_t *const rtti = gcc_rtti_t::instance();
+	if (!rtti)
+	{
+		return;
+	}
+
+	if (m_dirty.empty() && m_dirty_segments.empty())
+	{
+		// exports are written once there were no changes for a while, not after every edit
+		if (m_refresh_ticks > 0 && --m_refresh_ticks == 0)
+		{
+			rtti->refresh_outputs();
+		}
+		return;
+	}
+
+	const rangeset_t dirty = m_dirty;
+	const rangeset_t dirty_segments = m_dirty_segments;
+	m_dirty.clear();
+	m_dirty_segments.clear();
+
+	m_updating = true;
+	rtti->update(dirty, dirty_segments, m_own);
+	m_updating = false;
+
+	m_settling = !m_own.empty();
+	m_refresh_ticks = REFRESH_DELAY;
+}
+
+/* eof */
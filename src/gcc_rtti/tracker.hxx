@@ -0,0 +1,58 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#pragma once
+
+#include "gcc_rtti.hxx"
+
+/**
+ * Keeps parsed classes up to date after plugin has been run.
+ * IDB notifications only mark changed ranges as dirty, these are parsed again from timer,
+ * once auto analysis is idle, so burst of changes is processed at once. Ranges formatted by update
+ * are ignored until auto analysis queue drains, so plugin does not parse its own changes again.
+ * Exported graph is written again only after there were no changes for REFRESH_DELAY ticks.
+ */
+class tracker_t
+{
+public:
+	tracker_t();
+	tracker_t(tracker_t const&) = delete;
+	~tracker_t();
+
+	tracker_t &operator=(tracker_t const&) = delete;
+
+	void start();
+	void stop();
+
+private:
+	static ssize_t idaapi idb_event_s(void *user_data, int code, va_list va);
+	static int idaapi timer_s(void *user_data);
+
+	void on_idb_event(const int code, va_list va);
+	void mark_dirty(const range_t &range);
+	void process();
+
+private:
+	static const int TIMER_INTERVAL = 1000; // ms
+	static const int REFRESH_DELAY = 5;		// timer ticks without changes before graph is exported again
+
+	rangeset_t	m_dirty;			// changed bytes
+	rangeset_t	m_dirty_segments;	// added or moved segments, their data have to be loaded again
+	rangeset_t	m_own;				// ranges formatted by last update
+	qtimer_t	m_timer;
+	int			m_refresh_ticks;	// ticks left until graph is exported again, 0 if it is up to date
+	bool		m_active;
+	bool		m_updating;			// changes made by plugin itself are not tracked
+	bool		m_settling;			// auto analysis may still report changes in m_own
+};
+
+/* eof */
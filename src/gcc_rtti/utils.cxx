@@ -146,6 +146,63 @@ namespace utils
 		return result;
 	}
 
+	sstring_t trim_string(const sstring_t &text)
+	{
+		const char *begin = text.c_str();
+		const char *end = begin + text.length();
+
+		while (begin != end && qisspace(*begin)) { ++begin; }
+		while (end != begin && qisspace(*(end - 1))) { --end; }
+
+		return sstring_t(begin, end - begin);
+	}
+
+	sstring_t escape_string(const char *const text)
+	{
+		sstring_t result;
+		for (const char *c = text; *c; ++c)
+		{
+			if (*c == '\\' || *c == '"')
+			{
+				result.append('\\');
+			}
+			else if (static_cast<uchar>(*c) < 0x20)
+			{
+				// control characters are not allowed in JSON strings
+				result.cat_sprnt("\\u%04X", static_cast<uint>(static_cast<uchar>(*c)));
+				continue;
+			}
+			result.append(*c);
+		}
+		return result;
+	}
+
+	array_dyn_t<sstring_t> split_string(const char *const text, const char separator)
+	{
+		array_dyn_t<sstring_t> result;
+
+		const char *begin = text;
+		for (const char *c = text;; ++c)
+		{
+			if (*c == separator || *c == '\0')
+			{
+				const sstring_t part = trim_string(sstring_t(begin, c - begin));
+				if (!part.empty())
+				{
+					result.push_back(part);
+				}
+
+				if (*c == '\0')
+				{
+					break;
+				}
+				begin = c + 1;
+			}
+		}
+
+		return result;
+	}
+
 	ea_t get_ea(const ea_t address)
 	{
 	#ifdef __EA64__
@@ -155,6 +212,19 @@ namespace utils
 	#endif
 	}
 
+	ea_t get_fixup_target(const ea_t source)
+	{
+		fixup_data_t fixup;
+		if (!get_fixup(&fixup, source))
+		{
+			return BADADDR;
+		}
+
+		// extern symbols (FIXUPF_EXTDEF) keep addend in displacement
+		const ea_t base = (fixup.sel == BADSEL) ? 0 : sel2ea(fixup.sel);
+		return base + fixup.off + fixup.displacement;
+	}
+
 	void force_ptr(const ea_t address, size_t delta/* = 0 */)
 	{
 	#ifdef __EA64__
@@ -183,6 +253,130 @@ namespace utils
 		}
 	}
 
+	sstring_t make_identifier(const char *const text)
+	{
+		sstring_t result(text);
+		for (size_t i = 0; i < result.length(); ++i)
+		{
+			const char c = result[i];
+			if (!qisalnum(static_cast<uchar>(c)) && c != '_')
+			{
+				result[i] = '_';
+			}
+		}
+		return result;
+	}
+
+	uint64 hash_string(const char *const text)
+	{
+		uint64 hash = 0xcbf29ce484222325ULL;
+		for (const char *c = text; *c; ++c)
+		{
+			hash ^= static_cast<uchar>(*c);
+			hash *= 0x100000001b3ULL;
+		}
+		return hash;
+	}
+
+	uint64 hash_combine(const uint64 hash, const uint64 value)
+	{
+		return (hash ^ (value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2))) * 0x100000001b3ULL;
+	}
+
+	uint32 string_pool_t::add(const char *const text)
+	{
+		const uint32 offset = static_cast<uint32>(m_data.size());
+		for (const char *c = text; *c; ++c)
+		{
+			m_data.push_back(*c);
+		}
+		m_data.push_back('\0');
+		return offset;
+	}
+
+	const char *string_pool_t::get(const uint32 offset) const
+	{
+		return &m_data[offset];
+	}
+
+	void string_pool_t::assign(const char *const data, const uint32 size)
+	{
+		m_data.clear();
+		m_data.insert(m_data.end(), data, data + size);
+	}
+
+	void string_pool_t::clear()
+	{
+		m_data.clear();
+	}
+
+	bool string_pool_t::empty() const
+	{
+		return m_data.empty();
+	}
+
+	uint32 string_pool_t::size() const
+	{
+		return static_cast<uint32>(m_data.size());
+	}
+
+	const char *string_pool_t::data() const
+	{
+		return m_data.empty() ? nullptr : &m_data[0];
+	}
+
+	bool read_file(const char *const filepath, const char *const description, const size_t min_size, array_dyn_t<uchar> &data)
+	{
+		data.clear();
+
+		FILE *const file = qfopen(filepath, "rb");
+		if (!file)
+		{
+			msg("Unable to open %s %s\n", description, filepath);
+			return false;
+		}
+
+		const uint64 size = qfsize(file);
+		if (size >= min_size && size < 0x80000000)
+		{
+			data.resize(static_cast<size_t>(size));
+			if (qfread(file, &data[0], data.size()) != static_cast<ssize_t>(data.size()))
+			{
+				data.clear();
+			}
+		}
+		qfclose(file);
+
+		if (data.empty())
+		{
+			msg("Unable to read %s %s\n", description, filepath);
+			return false;
+		}
+		return true;
+	}
+
+	bool check_file(const array_dyn_t<uchar> &data, const char *const filepath, const char *const description,
+		const char (&magic)[4], const uint32 version, const uint64 expected_size, const uint32 strings_size)
+	{
+		uint32 file_version = 0;
+		if (data.size() >= sizeof(magic) + sizeof(file_version))
+		{
+			memcpy(&file_version, &data[sizeof(magic)], sizeof(file_version));
+		}
+
+		if (data.size() < sizeof(magic) + sizeof(file_version)
+		 || memcmp(&data[0], magic, sizeof(magic)) != 0
+		 || file_version != version
+		 || strings_size == 0
+		 || expected_size != data.size()
+		 || data.back() != '\0')
+		{
+			msg("%s %s is corrupted or has unsupported version\n", description, filepath);
+			return false;
+		}
+		return true;
+	}
+
 	ea_t sig_next(ea_t x, ea_t b)
 	{
 	#ifdef __EA64__
@@ -67,6 +67,9 @@ namespace utils
 
 	ea_t get_ea(const ea_t address);
 
+	/* address which fixup at source points to, BADADDR if there is no fixup */
+	ea_t get_fixup_target(const ea_t source);
+
 	void force_ptr(const ea_t address, size_t delta = 0);
 
 	static inline bool is_bad_addr(const ea_t address)
@@ -76,6 +79,50 @@ namespace utils
 
 	sstring_t ea_to_bytes(const ea_t address);
 
+	/* removes leading and trailing white spaces */
+	sstring_t trim_string(const sstring_t &text);
+
+	/* escapes backslashes, quotes and control characters, so text can be put into JSON string */
+	sstring_t escape_string(const char *const text);
+
+	/* splits text by separator, trims parts and skips empty ones */
+	array_dyn_t<sstring_t> split_string(const char *const text, const char separator);
+
+	/* replaces characters which are not allowed in names (i.e. of demangled templates) with '_' */
+	sstring_t make_identifier(const char *const text);
+
+	/* 64-bit FNV-1a hash of zero terminated string */
+	uint64 hash_string(const char *const text);
+
+	/* mixes value into hash, order of values matters */
+	uint64 hash_combine(const uint64 hash, const uint64 value);
+
+	/* zero terminated strings one after another, referenced by offset (string tables of saved files and indices) */
+	class string_pool_t
+	{
+	public:
+		uint32 add(const char *const text);
+		const char *get(const uint32 offset) const;
+
+		void assign(const char *const data, const uint32 size);
+		void clear();
+
+		bool empty() const;
+		uint32 size() const;
+		const char *data() const;
+
+	private:
+		array_dyn_t<char> m_data;
+	};
+
+	/* reads whole file (at least min_size bytes, less than 2 GB), description names file in messages */
+	bool read_file(const char *const filepath, const char *const description, const size_t min_size, array_dyn_t<uchar> &data);
+
+	/* checks magic and version which start every saved file, its size computed from header
+	   and zero which ends string table at end of file */
+	bool check_file(const array_dyn_t<uchar> &data, const char *const filepath, const char *const description,
+		const char (&magic)[4], const uint32 version, const uint64 expected_size, const uint32 strings_size);
+
 	/* sign extend b low bits in x */
 	/* from "Bit Twiddling Hacks" */
 	ea_t sig_next(ea_t x, ea_t b);
@@ -0,0 +1,394 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#include <stdinc.hxx>
+
+#include "vtables.hxx"
+
+const uint32 vtables_t::NO_INDEX;
+const sval_t vtables_t::MAX_OFFSET_TO_TOP;
+const ea_t vtables_t::MAX_GROUP_GAP;
+
+void vtables_t::build(const gcc_rtti_t::segments_data_t &segments_data)
+{
+	clear();
+
+	build_code_map();
+	if (m_code_map.empty())
+	{
+		return;
+	}
+
+	for (const gcc_rtti_t::segment_data_t &segment_data : segments_data)
+	{
+		scan(segment_data);
+	}
+
+	cluster();
+}
+
+void vtables_t::clear()
+{
+	m_code_segments.clear();
+	m_code_map.clear();
+	m_code_start = BADADDR;
+	m_code_size = 0;
+	m_vtables.clear();
+	m_slots.clear();
+}
+
+auto vtables_t::get_vtables() const -> const array_dyn_t<vtable_t> &
+{
+	return m_vtables;
+}
+
+ea_t vtables_t::get_slot(const vtable_t &vtable, const uint32 index) const
+{
+	return m_slots[vtable.m_first_slot + index];
+}
+
+void vtables_t::build_code_map()
+{
+	array_dyn_t<range_t> ranges;
+	array_dyn_t<bool> has_functions;
+
+	for (int segment_id = 0; segment_id < get_segm_qty(); ++segment_id)
+	{
+		segment_t *const segment = getnseg(segment_id);
+		if (!segment)
+		{
+			continue;
+		}
+
+		qstring segment_class;
+		get_segm_class(&segment_class, segment);
+
+		// imported functions (i.e. __cxa_pure_virtual) may be placed in extern segment
+		if (segment_class == "CODE" || segment_class == "XTRN")
+		{
+			ranges.push_back(range_t(segment->start_ea, segment->end_ea));
+			has_functions.push_back(false);
+		}
+	}
+
+	if (ranges.empty())
+	{
+		return;
+	}
+
+	std::sort(ranges.begin(), ranges.end(), [](const range_t &lhs, const range_t &rhs)
+	{
+		return lhs.start_ea < rhs.start_ea;
+	});
+
+	// bitmap of every segment is as large as segment itself, gaps between segments take no memory
+	size_t words = 0;
+	for (const range_t &range : ranges)
+	{
+		m_code_segments.push_back(code_segment_t{ range.start_ea, range.size(), words });
+		words += static_cast<size_t>((range.size() + 63) / 64);
+	}
+	m_code_map.resize(words, 0);
+
+	m_code_start = ranges.front().start_ea;
+	m_code_size = ranges.back().end_ea - m_code_start;
+
+	// virtual methods are function starts, so only these are marked when functions are known
+	const size_t function_count = get_func_qty();
+	for (size_t i = 0; i < function_count; ++i)
+	{
+		const func_t *const function = getn_func(i);
+		if (!function)
+		{
+			continue;
+		}
+
+		const auto found = std::upper_bound(ranges.begin(), ranges.end(), function->start_ea,
+			[](const ea_t address, const range_t &range)
+			{
+				return address < range.start_ea;
+			}
+		);
+		if (found == ranges.begin() || !(found - 1)->contains(function->start_ea))
+		{
+			continue;
+		}
+
+		const size_t index = (found - 1) - ranges.begin();
+		has_functions[index] = true;
+		mark_code(m_code_segments[index], function->start_ea, function->start_ea + 1);
+	}
+
+	for (size_t i = 0; i < ranges.size(); ++i)
+	{
+		if (!has_functions[i])
+		{
+			mark_code(m_code_segments[i], ranges[i].start_ea, ranges[i].end_ea);
+		}
+	}
+}
+
+void vtables_t::mark_code(const code_segment_t &segment, const ea_t start, const ea_t end)
+{
+	uint64 *const map = &m_code_map[segment.m_first_word];
+
+	ea_t bit = start - segment.m_start;
+	const ea_t last = end - segment.m_start;
+
+	for (; bit < last && (bit & 63) != 0; ++bit)
+	{
+		map[bit >> 6] |= 1ull << (bit & 63);
+	}
+
+	for (; bit + 64 <= last; bit += 64)
+	{
+		map[bit >> 6] = ~0ull;
+	}
+
+	for (; bit < last; ++bit)
+	{
+		map[bit >> 6] |= 1ull << (bit & 63);
+	}
+}
+
+auto vtables_t::find_code_segment(const ea_t address) const -> const code_segment_t *
+{
+	const auto found = std::upper_bound(m_code_segments.begin(), m_code_segments.end(), address,
+		[](const ea_t value, const code_segment_t &segment)
+		{
+			return value < segment.m_start;
+		}
+	);
+
+	if (found == m_code_segments.begin() || address - (found - 1)->m_start >= (found - 1)->m_size)
+	{
+		return nullptr;
+	}
+	return &*(found - 1);
+}
+
+uint64 vtables_t::classify(const ea_t *const words, const size_t count) const
+{
+	// range check against span of all code segments has no branches, so compiler can vectorize it;
+	// most of data words (small integers, data pointers) are rejected here
+	uint64 candidates = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		candidates |= static_cast<uint64>(words[i] - m_code_start < m_code_size) << i;
+	}
+
+	if (candidates == 0)
+	{
+		return 0;
+	}
+
+	// bit i is set when words[i] points into code; pointers of a run usually go to the same segment,
+	// so segment of previous code pointer is tried before lookup
+	const code_segment_t *segment = nullptr;
+
+	uint64 mask = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (((candidates >> i) & 1) == 0)
+		{
+			continue;
+		}
+
+		if (!segment || words[i] - segment->m_start >= segment->m_size)
+		{
+			segment = find_code_segment(words[i]);
+			if (!segment)
+			{
+				continue;
+			}
+		}
+
+		const ea_t bit = words[i] - segment->m_start;
+		mask |= static_cast<uint64>((m_code_map[segment->m_first_word + static_cast<size_t>(bit >> 6)] >> (bit & 63)) & 1) << i;
+	}
+	return mask;
+}
+
+bool vtables_t::is_referenced_from_code(const ea_t address) const
+{
+	xrefblk_t xb;
+	for (bool ok = xb.first_to(address, XREF_DATA); ok; ok = xb.next_to())
+	{
+		if (find_code_segment(xb.from))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void vtables_t::scan(const gcc_rtti_t::segment_data_t &segment_data)
+{
+	const size_t count = segment_data.m_data.size() / sizeof(ea_t);
+	if (count == 0)
+	{
+		return;
+	}
+
+	const ea_t *const words = reinterpret_cast<const ea_t *>(&segment_data.m_data[0]);
+
+	size_t run_start = 0;
+	bool in_run = false;
+
+	for (size_t block = 0; block < count; block += 64)
+	{
+		const size_t block_size = std::min<size_t>(64, count - block);
+		const uint64 mask = classify(&words[block], block_size);
+
+		// most of blocks either do not contain code pointers at all or are inside of long run
+		if ((!in_run && mask == 0) || (in_run && block_size == 64 && mask == ~0ull))
+		{
+			continue;
+		}
+
+		for (size_t i = 0; i < block_size; ++i)
+		{
+			const bool code = ((mask >> i) & 1) != 0;
+			if (code && !in_run)
+			{
+				run_start = block + i;
+				in_run = true;
+			}
+			else if (!code && in_run)
+			{
+				add_candidate(segment_data, run_start, block + i);
+				in_run = false;
+			}
+		}
+	}
+
+	if (in_run)
+	{
+		add_candidate(segment_data, run_start, count);
+	}
+}
+
+void vtables_t::add_candidate(const gcc_rtti_t::segment_data_t &segment_data, const size_t start, const size_t end)
+{
+	// offset to top, null type info pointer, virtual methods
+	const ea_t *const words = reinterpret_cast<const ea_t *>(&segment_data.m_data[0]);
+
+	if (start < 2 || words[start - 1] != 0)
+	{
+		return;
+	}
+
+	const sval_t offset_to_top = static_cast<sval_t>(words[start - 2]);
+	if (offset_to_top > 0 || offset_to_top < -MAX_OFFSET_TO_TOP || (-offset_to_top) % static_cast<sval_t>(sizeof(ea_t)) != 0)
+	{
+		return;
+	}
+
+	const ea_t address_point = segment_data.m_start_ea + start * sizeof(ea_t);
+	if (!has_xref(get_flags(address_point)))
+	{
+		return;
+	}
+
+	// single code pointer after the header is common in other data, constructor or destructor has to store it
+	if (end - start == 1 && !is_referenced_from_code(address_point))
+	{
+		return;
+	}
+
+	vtable_t vtable;
+	vtable.m_address = address_point - sizeof(ea_t);
+	vtable.m_offset_to_top = offset_to_top;
+	vtable.m_first_slot = static_cast<uint32>(m_slots.size());
+	vtable.m_slot_count = static_cast<uint32>(end - start);
+	vtable.m_primary = NO_INDEX;
+	vtable.m_parent = NO_INDEX;
+
+	if (offset_to_top == 0)
+	{
+		vtable.m_primary = static_cast<uint32>(m_vtables.size());
+	}
+	else if (!m_vtables.empty())
+	{
+		// secondary vtable follows primary one (and other secondary ones) of the same class
+		const vtable_t &previous = m_vtables.back();
+		const ea_t previous_end = previous.m_address + sizeof(ea_t) * (previous.m_slot_count + 1);
+
+		if (previous.m_address >= segment_data.m_start_ea
+		 && previous_end <= vtable.m_address - sizeof(ea_t)
+		 && vtable.m_address - sizeof(ea_t) - previous_end <= MAX_GROUP_GAP)
+		{
+			vtable.m_primary = previous.m_primary;
+		}
+	}
+
+	m_slots.insert(m_slots.end(), &words[start], &words[end]);
+	m_vtables.push_back(vtable);
+}
+
+void vtables_t::cluster()
+{
+	// trie of slots, node of every slot is remembered, so prefixes are checked without lookups
+	array_dyn_t<uint32> node_vtable;	// primary vtable ending at node
+	node_vtable.push_back(NO_INDEX);	// root
+
+	array_dyn_t<uint32> slot_nodes;
+	slot_nodes.resize(m_slots.size(), 0);
+
+	// methods get dense ids, so edge of trie (parent node, method) fits into single key of hash table
+	hash_map_t<ea_t, uint32> methods;
+	hash_map_t<uint64, uint32> children;
+	methods.reserve(m_slots.size());
+	children.reserve(m_slots.size());
+
+	for (uint32 index = 0; index < m_vtables.size(); ++index)
+	{
+		const vtable_t &vtable = m_vtables[index];
+
+		uint32 node = 0;
+		for (uint32 slot = vtable.m_first_slot; slot < vtable.m_first_slot + vtable.m_slot_count; ++slot)
+		{
+			const uint32 method = methods.emplace(m_slots[slot], static_cast<uint32>(methods.size())).first->second;
+			const uint64 edge = (static_cast<uint64>(node) << 32) | method;
+
+			const auto inserted = children.emplace(edge, static_cast<uint32>(node_vtable.size()));
+			if (inserted.second)
+			{
+				node_vtable.push_back(NO_INDEX);
+			}
+
+			node = inserted.first->second;
+			slot_nodes[slot] = node;
+		}
+
+		// the same slots in more vtables are ambiguous, first one wins
+		if (vtable.m_offset_to_top == 0 && node_vtable[node] == NO_INDEX)
+		{
+			node_vtable[node] = index;
+		}
+	}
+
+	// parent is the longest primary vtable which is proper prefix
+	for (vtable_t &vtable : m_vtables)
+	{
+		for (uint32 slot = vtable.m_first_slot; slot + 1 < vtable.m_first_slot + vtable.m_slot_count; ++slot)
+		{
+			const uint32 candidate = node_vtable[slot_nodes[slot]];
+			if (candidate != NO_INDEX)
+			{
+				vtable.m_parent = candidate;
+			}
+		}
+	}
+}
+
+/* eof */
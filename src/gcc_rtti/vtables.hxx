@@ -0,0 +1,81 @@
+/***************************************************************************************************************
+ *
+ * Class informer, plugin for Interactive Disassembler (IDA)
+ *
+ * Rewritten to C++14, modified and optimized GCC RTTI parsing code originally written by:
+ * ^ Igor Skochinsky, see http://www.hexblog.com/?p=704 for the original version of this code
+ * ^ NCC Group, see https://github.com/nccgroup/PythonClassInformer for the modified version of the code above
+ *
+ * This code has been written by Michał Wójtowicz a.k.a mwl4, 02/2018
+ *
+ ***************************************************************************************************************/
+
+#pragma once
+
+#include "gcc_rtti.hxx"
+
+/**
+ * Detector of vtables in binaries built without RTTI (-fno-rtti), where type info pointer of every vtable is null.
+ * Vtable is recognized as offset to top and null type info pointer followed by run of pointers into code,
+ * whose address point is referenced (constructors and destructors store it into object).
+ * Data segments are read once, words are classified in blocks of 64: branch-free check against span of all
+ * code segments first, then only passing words are looked up in bitmaps of code segments.
+ * Every code segment has its own bitmap, so sparse address space (i.e. far extern segment) costs nothing.
+ * Vtable with single slot is accepted only when its address point is referenced from code.
+ *
+ * Vtable whose slots are proper prefix of slots of another vtable is treated as its base (derived class
+ * appends its new virtual methods after inherited ones), such prefixes are found with trie of slots.
+ */
+class vtables_t
+{
+public:
+	static const uint32 NO_INDEX = 0xFFFFFFFF;
+
+	struct vtable_t
+	{
+		ea_t	m_address;		// address of type info pointer (address point - ptrsize), same as class_t::m_vtable
+		sval_t	m_offset_to_top;// 0 for primary vtable, negative for secondary ones of the same group
+		uint32	m_first_slot;	// index into slots
+		uint32	m_slot_count;
+		uint32	m_primary;		// primary vtable of group, NO_INDEX if secondary vtable has none
+		uint32	m_parent;		// primary vtable which slots are prefix of this one, NO_INDEX if there is none
+	};
+
+public:
+	void build(const gcc_rtti_t::segments_data_t &segments_data);
+	void clear();
+
+	const array_dyn_t<vtable_t> &get_vtables() const;
+	ea_t get_slot(const vtable_t &vtable, const uint32 index) const;
+
+private:
+	class code_segment_t
+	{
+	public:
+		ea_t	m_start;
+		ea_t	m_size;
+		size_t	m_first_word;	// first word of bitmap of segment in m_code_map
+	};
+
+	void build_code_map();
+	void mark_code(const code_segment_t &segment, const ea_t start, const ea_t end);
+	const code_segment_t *find_code_segment(const ea_t address) const;
+	bool is_referenced_from_code(const ea_t address) const;
+	uint64 classify(const ea_t *const words, const size_t count) const;
+	void scan(const gcc_rtti_t::segment_data_t &segment_data);
+	void add_candidate(const gcc_rtti_t::segment_data_t &segment_data, const size_t start, const size_t end);
+	void cluster();
+
+private:
+	static const sval_t MAX_OFFSET_TO_TOP = 0x100000;
+	static const ea_t	MAX_GROUP_GAP = sizeof(ea_t) * 16;	// vcall and vbase offsets between vtables of group
+
+	array_dyn_t<code_segment_t> m_code_segments;	// sorted by address
+	array_dyn_t<uint64>		m_code_map;	// bit per byte of every code segment, one after another
+	ea_t					m_code_start;	// span from first to last code segment, for quick rejection of words
+	ea_t					m_code_size;
+	array_dyn_t<vtable_t>	m_vtables;
+	array_dyn_t<ea_t>		m_slots;
+};
+
+/* eof */